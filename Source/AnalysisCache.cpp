@@ -0,0 +1,244 @@
+/*
+ This is Paraphrasis synthesiser.
+
+ Copyright (c) 2026 by the Paraphrasis contributors
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY, without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ */
+
+#include "AnalysisCache.h"
+
+#include "Breakpoint.h"
+#include "Partial.h"
+
+#include <algorithm>
+
+static const int kEntryMagic = 0x43415050;  // "PPAC"
+
+/**
+ Revision of the analysis pipeline and of the entry layout. Bump it when
+ Loris or the post processing produce different partials, old entries are
+ not hit then and they are evicted in time.
+ */
+static const int kEntryRevision = 1;
+
+static const int kPartialHeaderBytes = 2 * 4;   // label and number of breakpoints
+static const int kBreakpointBytes = 5 * 8;      // time, frequency, amplitude, bandwidth and phase
+
+//==============================================================================
+/** 64 bit FNV-1a hash. */
+class Fnv1a
+{
+public:
+    void add(const void *data, size_t numBytes) noexcept
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+
+    uint64_t get() const noexcept { return hash; }
+
+private:
+    uint64_t hash = 0xcbf29ce484222325ULL;
+};
+
+//==============================================================================
+AnalysisCache::AnalysisCache(const File &directory, int64 maxBytes)
+    : directory(directory),
+      maxBytes(maxBytes)
+{
+
+}
+
+//==============================================================================
+File AnalysisCache::getDefaultDirectory()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+                .getChildFile("Paraphrasis").getChildFile("AnalysisCache");
+}
+
+//==============================================================================
+String AnalysisCache::makeKey(const File &audioFile, double resolutionHz, double pitchHz, bool reverse)
+{
+    FileInputStream input(audioFile);
+
+    if (input.failedToOpen())
+        return String::empty;
+
+    Fnv1a content;
+    HeapBlock<char> chunk(65536);
+    for (int read; (read = input.read(chunk, 65536)) > 0;)
+        content.add(chunk, (size_t) read);
+
+    // content first, parameters hashed as text so that the key does not depend on endianness
+    const String parameters = String::toHexString((int64) content.get())
+                            + " " + String(input.getTotalLength())
+                            + " " + String(resolutionHz, 6)
+                            + " " + String(pitchHz, 6)
+                            + " " + String((int) reverse)
+                            + " " + String(kEntryRevision);
+
+    Fnv1a key;
+    key.add(parameters.toRawUTF8(), parameters.getNumBytesAsUTF8());
+
+    return String::toHexString((int64) key.get()).paddedLeft('0', 16);
+}
+
+//==============================================================================
+void AnalysisCache::writePartials(OutputStream &output, const Loris::PartialList &partials)
+{
+    output.writeInt(kEntryMagic);
+    output.writeInt(kEntryRevision);
+    output.writeInt((int) partials.size());
+
+    for (const Loris::Partial &partial : partials)
+    {
+        output.writeInt(partial.label());
+        output.writeInt(partial.numBreakpoints());
+
+        for (Loris::Partial::const_iterator it = partial.begin(); it != partial.end(); ++it)
+        {
+            const Loris::Breakpoint &bp = it.breakpoint();
+            output.writeDouble(it.time());
+            output.writeDouble(bp.frequency());
+            output.writeDouble(bp.amplitude());
+            output.writeDouble(bp.bandwidth());
+            output.writeDouble(bp.phase());
+        }
+    }
+}
+
+//==============================================================================
+bool AnalysisCache::readPartials(InputStream &input, Loris::PartialList &partials)
+{
+    Loris::PartialList loaded;
+
+    if (input.readInt() != kEntryMagic || input.readInt() != kEntryRevision)
+        return false;
+
+    // do not trust damaged counts, every partial takes at least its header and one breakpoint
+    const int numPartials = input.readInt();
+    const int64 remaining = input.getNumBytesRemaining();
+    if (numPartials < 0 || (remaining >= 0 && numPartials > remaining / (kPartialHeaderBytes + kBreakpointBytes)))
+        return false;
+
+    for (int n = 0; n < numPartials; ++n)
+    {
+        if (input.isExhausted())
+            return false;
+
+        const int label = input.readInt();
+        const int numBreakpoints = input.readInt();
+
+        if (numBreakpoints <= 0 || input.isExhausted())
+            return false;
+
+        Loris::Partial partial;
+        partial.setLabel(label);
+        for (int i = 0; i < numBreakpoints; ++i)
+        {
+            const double time      = input.readDouble();
+            const double frequency = input.readDouble();
+            const double amplitude = input.readDouble();
+            const double bandwidth = input.readDouble();
+            const double phase     = input.readDouble();
+
+            if (input.isExhausted() && i + 1 < numBreakpoints)
+                return false;
+
+            partial.insert(time, Loris::Breakpoint(frequency, amplitude, bandwidth, phase));
+        }
+
+        loaded.push_back(partial);
+    }
+
+    partials.clear();
+    partials.splice(partials.end(), loaded);
+    return true;
+}
+
+//==============================================================================
+bool AnalysisCache::load(const String &key, Loris::PartialList &partials) const
+{
+    const File entry(getEntryFile(key));
+    FileInputStream input(entry);
+
+    if (input.failedToOpen())
+        return false;
+
+    if (! readPartials(input, partials) || ! input.isExhausted())
+    {
+        entry.deleteFile();
+        return false;
+    }
+
+    // least recently used is judged by modification time, access times are often not kept
+    entry.setLastModificationTime(Time::getCurrentTime());
+    return true;
+}
+
+//==============================================================================
+void AnalysisCache::store(const String &key, const Loris::PartialList &partials) const
+{
+    if (key.isEmpty() || ! directory.createDirectory())
+        return;
+
+    const File entry(getEntryFile(key));
+    TemporaryFile temp(entry);
+
+    {
+        FileOutputStream output(temp.getFile());
+
+        if (output.failedToOpen())
+            return;
+
+        writePartials(output, partials);
+
+        output.flush();
+        if (output.getStatus().failed())
+            return;
+    }
+
+    if (temp.overwriteTargetFileWithTemporary())
+        trim();
+}
+
+//==============================================================================
+void AnalysisCache::trim() const
+{
+    Array<File> entries;
+    directory.findChildFiles(entries, File::findFiles, false, "*.partials");
+
+    int64 totalBytes = 0;
+    for (int i = entries.size(); --i >= 0;)
+        totalBytes += entries.getReference(i).getSize();
+
+    if (totalBytes <= maxBytes)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const File &a, const File &b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (int i = 0; i < entries.size() && totalBytes > maxBytes; ++i)
+    {
+        const int64 size = entries.getReference(i).getSize();
+        if (entries.getReference(i).deleteFile())
+            totalBytes -= size;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ This is Paraphrasis synthesiser.
+
+ Copyright (c) 2026 by the Paraphrasis contributors
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY, without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ */
+#ifndef ANALYSISCACHE_H_INCLUDED
+#define ANALYSISCACHE_H_INCLUDED
+
+#include "JuceHeader.h"
+#include "PartialList.h"
+
+#include <stdint.h>
+
+/**
+ On-disk cache of analysed partials.
+
+ Entries are keyed by a hash of the audio file content and the analysis
+ parameters, so a renamed or copied file hits the cache and an edited one
+ does not. Entries are written to a temporary file and moved into place, a
+ crash never leaves a truncated entry behind. When the cache grows over its
+ size limit the least recently used entries are deleted.
+
+ Several analyzers, also in other processes, may share a cache directory.
+ */
+class AnalysisCache
+{
+public:
+    /**
+     Create cache object, the directory is created on the first store().
+     @param directory folder holding the cache entries.
+     @param maxBytes size limit of all entries together.
+     */
+    AnalysisCache(const File &directory = getDefaultDirectory(), int64 maxBytes = kDefaultMaxBytes);
+
+    /** Return cache folder in user's application data directory. */
+    static File getDefaultDirectory();
+
+    /**
+     Return key of the analysis of an audio file. Reads whole file.
+     @return key or empty string if the file can not be read.
+     */
+    static String makeKey(const File &audioFile, double resolutionHz, double pitchHz, bool reverse);
+
+    /**
+     Read partials stored under key.
+     @return true if the entry exists and is valid, partials are replaced then.
+     */
+    bool load(const String &key, Loris::PartialList &partials) const;
+
+    /** Store partials under key and evict old entries. Failures are ignored. */
+    void store(const String &key, const Loris::PartialList &partials) const;
+
+    /** Write partials to a stream in the format of cache entries. */
+    static void writePartials(OutputStream &output, const Loris::PartialList &partials);
+
+    /**
+     Read partials written by writePartials().
+     @return true if the data is valid, partials are replaced then.
+     */
+    static bool readPartials(InputStream &input, Loris::PartialList &partials);
+
+    /** Delete least recently used entries until the cache fits into its size limit. */
+    void trim() const;
+
+    static const int64 kDefaultMaxBytes = 256 * 1024 * 1024;
+
+private:
+    File getEntryFile(const String &key) const  { return directory.getChildFile(key + ".partials"); }
+
+    File directory;
+    int64 maxBytes;
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisCache)
+};
+
+#endif  // ANALYSISCACHE_H_INCLUDED
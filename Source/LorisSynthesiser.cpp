@@ -28,14 +28,19 @@
 /** Create new instance.
     @param tailTimeSec lenght of tail of the sound
  */
-LorisVoice::LorisVoice(double tailTimeSec) :  tailTimeSec(tailTimeSec), synth(buffer)
+LorisVoice::LorisVoice(double tailTimeSec) :  tailTimeSec(tailTimeSec)
 {
     synthesise = false;
     tailOff = false;
     
     tailSamples = tailTimeSec * getSampleRate();
     
-    buffer.reserve(kDefaultSynthesiserBufferSize);
+    maxBlockSize = kDefaultSynthesiserBufferSize;
+    buffer.reserve(maxBlockSize);
+    
+    // voices are created on the message thread, every one gets its own noise
+    static uint32 numVoices = 0;
+    noiseSeed = ++numVoices;
 }
 
 //==============================================================================
@@ -49,13 +54,13 @@ void LorisVoice::startNote(int midiNoteNumber, float velocity,
                SynthesiserSound* /*sound*/, int /*currentPitchWheelPosition*/) noexcept
 {
     // This will be called during the rendering callback, so must be fast and thread-safe.
-    const ScopedLock sl(lock);
+    if (synth == nullptr) return;
     
     level = velocity;
     tailOff = false;
     
-    synth.reset();
-    synth.setPitch(MidiMessage::getMidiNoteInHertz (midiNoteNumber));
+    synth->reset();
+    synth->setPitch(MidiMessage::getMidiNoteInHertz (midiNoteNumber));
     
     synthesise = true;
 }
@@ -104,29 +109,34 @@ void LorisVoice::aftertouchChanged(int /*newAftertouchValue*/) noexcept
 /** Setup voice to imitate sound with given partials. */
 void LorisVoice::renderNextBlock(AudioSampleBuffer& outputBuffer, int startSample, int numSamples) noexcept
 {
-    if (!synthesise) return;
-    
-    const ScopedLock sl(lock);
-    
-    synth.synthesizeNext(numSamples);
-    
-    double tailDiff = 0.;
-    
-    if (tailOff)
+    // blocks longer than the synthesizer is prepared for are rendered in parts
+    while (synthesise && numSamples > 0)
     {
-        tailDiff = level * (double) numSamples / (double) tailSamples;// change level due to tail position
-        if (level < tailDiff) // prevent negative gain
-            tailDiff = level;
-    }
+        const int num = jmin(numSamples, synth->getMaxBlockSize());
+        
+        synth->synthesizeNext(num);
+        
+        double tailDiff = 0.;
+        
+        if (tailOff)
+        {
+            tailDiff = level * (double) num / (double) tailSamples;// change level due to tail position
+            if (level < tailDiff) // prevent negative gain
+                tailDiff = level;
+        }
 
-    outputBuffer.addFromWithRamp(0, startSample, buffer.data(), numSamples, level, level - tailDiff);
-    
-    if (tailOff)
-    {
-        level -= tailDiff;
+        outputBuffer.addFromWithRamp(0, startSample, buffer.data(), num, level, level - tailDiff);
+        
+        if (tailOff)
+        {
+            level -= tailDiff;
 
-        if (level <= 0.005) // this number is from Juce synthesiser tutorial.
-            stop();
+            if (level <= 0.005) // this number is from Juce synthesiser tutorial.
+                stop();
+        }
+        
+        startSample += num;
+        numSamples -= num;
     }
 }
 
@@ -140,20 +150,53 @@ void LorisVoice::stop() noexcept
 }
 
 //==============================================================================
-void LorisVoice::setup(Loris::PartialList &partials, double pitch) noexcept
+Loris::RealTimeSynthesizer *LorisVoice::createSynth(const Loris::RealtimePartialBank::Ptr &bank, double pitch)
 {
-    const ScopedLock sl(lock);
-    synth.setup(partials, pitch);
+    Loris::RealTimeSynthesizer *newSynth = new Loris::RealTimeSynthesizer(buffer);
+    
+    newSynth->setSampleRate(getSampleRate());
+    newSynth->setNoiseSeed(noiseSeed);
+    newSynth->setMaxBlockSize(maxBlockSize);
+    newSynth->setup(bank, pitch);
+    
+    return newSynth;
 }
 
 //==============================================================================
-void LorisVoice::setCurrentPlaybackSampleRate(double rate) noexcept
+void LorisVoice::setSynth(Loris::RealTimeSynthesizer *newSynth) noexcept
+{
+    stop();
+    synth = newSynth;
+}
+
+//==============================================================================
+void LorisVoice::continueWith(Loris::RealTimeSynthesizer *newSynth) noexcept
 {
-    const ScopedLock sl(lock);
+    if (synth != nullptr && newSynth != nullptr)
+        newSynth->continueFrom(*synth);
     
+    synth = newSynth;
+}
+
+//==============================================================================
+void LorisVoice::setDetail(double detail) noexcept
+{
+    if (synth != nullptr)
+        synth->setDetail(detail);
+}
+
+//==============================================================================
+void LorisVoice::setMaxBlockSize(int samples)
+{
+    maxBlockSize = jmax(1, samples);
+    buffer.reserve(maxBlockSize);
+}
+
+//==============================================================================
+void LorisVoice::setCurrentPlaybackSampleRate(double rate) noexcept
+{
+    // synthesizers are created for the new rate by LorisSynthesiser
     SynthesiserVoice::setCurrentPlaybackSampleRate(rate);
     
-    synth.setSampleRate(getSampleRate());
-    
     tailSamples = tailTimeSec * getSampleRate();
 }
\ No newline at end of file
@@ -30,6 +30,10 @@
 #include "RealtimeSynthesizer.h"
 #include "Resampler.h"
 
+#include "VoiceRenderPool.h"
+
+#include <atomic>
+
 using namespace juce;
 
 //==============================================================================
@@ -47,6 +51,9 @@ public:
 /**
  * Loris synthesiser voice for LorisSynthesiser. It makes a sound based on Partials
  * generated from Loris analysis. It synthesise only in mono!
+ *
+ * The voice does not own its Loris synthesizer, LorisSynthesiser prepares one
+ * for every voice off the audio thread and hands it over with setSynth().
  */
 class LorisVoice : public SynthesiserVoice
 {
@@ -73,8 +80,29 @@ public:
     
     void setCurrentPlaybackSampleRate(double rate) noexcept override;
     
-    /** Setup voice to imitate sound with given partials. */
-    void setup(Loris::PartialList &partials, double pitch) noexcept;
+    /**
+       Create synthesizer imitating sound with given partials for this voice. The
+       bank is shared, not copied. Call it off the audio thread, it allocates.
+     */
+    Loris::RealTimeSynthesizer *createSynth(const Loris::RealtimePartialBank::Ptr &bank, double pitch);
+    
+    /** Play using given synthesizer from now on, current note is stopped. Audio thread only. */
+    void setSynth(Loris::RealTimeSynthesizer *newSynth) noexcept;
+    
+    /**
+       Play using given synthesizer extending the sound of the current one, current
+       note goes on. Audio thread only, see Loris::RealTimeSynthesizer::continueFrom().
+     */
+    void continueWith(Loris::RealTimeSynthesizer *newSynth) noexcept;
+    
+    /** Set fraction of the loudest partials to render, see Loris::RealTimeSynthesizer::setDetail(). */
+    void setDetail(double detail) noexcept;
+    
+    /**
+       Set the longest block synthesizers created from now on render at once,
+       longer blocks are rendered in parts. Not realtime safe.
+     */
+    void setMaxBlockSize(int samples);
     
 private:
     
@@ -89,51 +117,338 @@ private:
     int tailSamples;      // Lenght of tail in samples.
     double tailTimeSec;   // Lenght of tail in seconds.
         
-    Loris::RealTimeSynthesizer synth;  // This makes the sound.
-    CriticalSection lock; // For safe processing.
+    Loris::RealTimeSynthesizer *synth = nullptr;  // This makes the sound, owned by LorisSynthesiser.
+    uint32 noiseSeed;                             // Noise of synthesizers of this voice.
     
     std::vector<float> buffer;         // Synthesiser's innner buffer.
+    int maxBlockSize;                  // Longest block of new synthesizers.
 };
 
+// CPU budget governor of LorisSynthesiser
+static const double kGovernorPeriodSec = 0.05; // longer than Loris::RealTimeSynthesizer::DetailFadeTime
+static const double kHeadroom = 0.7;           // raise detail below this fraction of the budget
+static const double kDetailStep = 0.05;        // detail raised per governor period
+static const double kMinDetail = 0.05;         // never cull more than this
+
 //==============================================================================
 /**
    LorisSynthesiser voice for LorisSynthesiser. It makes a sound based on Partials
    generated from Loris analysis.
  */
-class LorisSynthesiser : public Synthesiser
+class LorisSynthesiser : public Synthesiser, private VoiceRenderPool::Job
 {
 public:
+    /**
+       Render active voices in parallel on worker threads. Every voice renders
+       into its own buffer, the buffers are summed in voice order, so the output
+       does not depend on the number of threads. Not realtime safe.
+       @param numThreads number of workers besides the audio thread, 0 renders serially.
+       @param maxBlockSize longer blocks are rendered serially.
+     */
+    void setRenderThreads(int numThreads, int maxBlockSize)
+    {
+        const int numVoices = getNumVoices();
+        
+        voiceBuffers.clear();
+        for (int i = 0; i < numVoices && numThreads > 0; i++)
+            voiceBuffers.add(new AudioSampleBuffer(1, maxBlockSize));
+        activeVoices.ensureStorageAllocated(numVoices);
+        
+        pool.setNumThreads(numThreads);
+    }
+    
+    /**
+       The voices may spend this fraction of the block duration rendering
+       before the governor lowers their level of detail.
+     */
+    void setCpuBudget(double fraction) noexcept
+    {
+        cpuBudget = fraction;
+    }
+    
+    /**
+       Offline rendering (bouncing) is never governed, all partials are
+       rendered whatever it takes.
+     */
+    void setNonRealtime(bool isNonRealtime) noexcept
+    {
+        nonRealtime = isNonRealtime;
+        
+        if (nonRealtime && detail < 1.)
+            applyDetail(1.);
+    }
+    
+    /**
+       Set the longest block voices render at once, synthesizers preallocate
+       for it. Call it before setCurrentPlaybackSampleRate(), which prepares
+       new synthesizers. Not realtime safe.
+     */
+    void setMaxBlockSize(int samples)
+    {
+        const ScopedLock sl(dataLock);
+        
+        LorisVoice *voice;
+        for (int i = voices.size(); --i >= 0;)
+        {
+            voice = dynamic_cast<LorisVoice *>(voices.getUnchecked(i));
+            if (voice)
+                voice->setMaxBlockSize(samples);
+        }
+    }
     
+    /** Return the level of detail the governor keeps the voices at. */
+    double getDetail() const noexcept
+    {
+        return detail;
+    }
+    
+
     /**
-       Setup synthesiser's voices using partials.
+       Setup synthesiser's voices using partials. Synthesizers playing them are
+       prepared here and handed over to the audio thread by applyPendingPatch(),
+       until then voices keep playing the previous sound. Call it from any thread
+       but the audio one.
        @param partials data gathered at analysis stage
        @param samplePitch original pitch of partils data.
+       @param availableTime partials of a sample still being analysed are complete up to this
+                            time in seconds, voices do not play further; negative if complete.
      */
-    void setup(Loris::PartialList &partials, double samplePitch)
+    void setup(Loris::PartialList &partials, double samplePitch, double availableTime = -1.)
     {
-        allNotesOff(0, false); // clear all notes before setting new partials
+        const ScopedLock sl(dataLock);
         
         this->partials.clear();
         this->partials = std::move(partials);
         partials.clear(); // invalidate partials due to std::move
         
         this->samplePitch = samplePitch;
+        this->availableTime = availableTime;
+        
+        update(this->partials, this->samplePitch, false);
+    }
+    
+    /**
+       Extend the sound of the last setup() or extend() by partials found later by the
+       same analysis. The partials passed before have to come first, in the same order,
+       only with breakpoints appended after the previous available time. Playing notes
+       go on with the extended sound, voices waiting at the previous available time
+       continue. Call it from any thread but the audio one.
+       @param partials data gathered at analysis stage so far
+       @param availableTime partials are complete up to this time in seconds, negative if complete.
+     */
+    void extend(Loris::PartialList &partials, double availableTime = -1.)
+    {
+        const ScopedLock sl(dataLock);
+        
+        this->partials.clear();
+        this->partials = std::move(partials);
+        partials.clear(); // invalidate partials due to std::move
+        
+        this->availableTime = availableTime;
+        
+        update(this->partials, this->samplePitch, true);
+    }
+    
+    /** Copy partials of the current sound, nothing while it is being analysed. Not realtime safe. */
+    void getPartials(Loris::PartialList &copy)
+    {
+        const ScopedLock sl(dataLock);
         
-        update(this->partials, this->samplePitch);
+        if (availableTime < 0.)
+            copy = this->partials;
+        else
+            copy.clear();
     }
     
     void setCurrentPlaybackSampleRate(double newRate) override
     {
+        const ScopedLock sl(dataLock);
+        
         juce::Synthesiser::setCurrentPlaybackSampleRate(newRate);
     
-        update(this->partials, this->samplePitch);
+        update(this->partials, this->samplePitch, false);
+    }
+    
+    /**
+       Switch voices to the sound prepared by the last setup(), extend() or sample
+       rate change, if there is a new one. Playing notes are stopped, unless the
+       sound is extended. It only swaps pointers and copies playback state, call
+       it from the audio thread before rendering.
+     */
+    void applyPendingPatch() noexcept
+    {
+        // never full, see deleteRetiredPatches()
+        if (currentPatch != nullptr && retiredFifo.getFreeSpace() == 0)
+        {
+            jassertfalse;
+            return;
+        }
+        
+        Patch *patch = pendingPatch.exchange(nullptr);
+        if (patch == nullptr)
+            return;
+        
+        const bool continues = patch->continuesPrevious && currentPatch != nullptr;
+        if (!continues)
+            allNotesOff(0, false);
+        
+        LorisVoice *voice;
+        for (int i = voices.size(); --i >= 0;)
+        {
+            voice = dynamic_cast<LorisVoice *>(voices.getUnchecked(i));
+            if (voice && continues)
+                voice->continueWith(patch->synths[i]);
+            else if (voice)
+                voice->setSynth(patch->synths[i]);
+        }
+        
+        if (currentPatch != nullptr)
+        {
+            int start1, size1, start2, size2;
+            retiredFifo.prepareToWrite(1, start1, size1, start2, size2);
+            retired[start1] = currentPatch;
+            retiredFifo.finishedWrite(1);
+        }
+        currentPatch = patch;
+        
+        applyDetail(detail);
+    }
+    
+    ~LorisSynthesiser()
+    {
+        delete pendingPatch.exchange(nullptr);
+        deleteRetiredPatches();
+        delete currentPatch;
     }
 
+protected:
+    /**
+       Render the voices and measure how long it took. The level of detail of
+       all voices is lowered quickly when they exceed the budget and raised
+       slowly when there is headroom. It is updated once per governor period,
+       at least as long as the crossfade of culled partials, so the effect of
+       the previous change is measured.
+     */
+    void renderVoices(AudioSampleBuffer& outputAudio, int startSample, int numSamples) override
+    {
+        const int64 start = Time::getHighResolutionTicks();
+        
+        if (pool.getNumThreads() > 0 && voiceBuffers.size() > 0 && numSamples <= voiceBuffers[0]->getNumSamples())
+        {
+            // the same order as Synthesiser::renderVoices()
+            activeVoices.clearQuick();
+            for (int i = voices.size(); --i >= 0;)
+                if (voices.getUnchecked(i)->getCurrentlyPlayingNote() >= 0)
+                    activeVoices.add(voices.getUnchecked(i));
+            
+            renderSamples = numSamples;
+            pool.run(*this, activeVoices.size());
+            
+            for (int i = 0; i < activeVoices.size(); i++)
+                outputAudio.addFrom(0, startSample, *voiceBuffers.getUnchecked(i), 0, 0, numSamples);
+        }
+        else
+        {
+            Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+        }
+        
+        if (nonRealtime)
+            return;
+        
+        measuredTicks += Time::getHighResolutionTicks() - start;
+        measuredSamples += numSamples;
+        
+        const double sampleRate = getSampleRate();
+        if (sampleRate <= 0. || measuredSamples < kGovernorPeriodSec * sampleRate)
+            return;
+        
+        const double load = Time::highResolutionTicksToSeconds(measuredTicks) * sampleRate / measuredSamples;
+        measuredTicks = 0;
+        measuredSamples = 0;
+        
+        if (load > cpuBudget)
+            applyDetail(jmax(kMinDetail, detail * jmax(0.5, cpuBudget / load)));
+        else if (load < cpuBudget * kHeadroom && detail < 1.)
+            applyDetail(jmin(1., detail + kDetailStep));
+    }
+    
 private:
+    /** Synthesizers of all voices playing one sound. */
+    struct Patch
+    {
+        OwnedArray<Loris::RealTimeSynthesizer> synths; // one for every voice, null for other voices
+        bool continuesPrevious = false;                // extends the sound of the previous patch
+    };
+    
     Loris::PartialList partials;
     double samplePitch;
+    double availableTime = -1.; // partials are complete up to this time, negative if complete
+    CriticalSection dataLock;   // partials and sample rate, never locked by the audio thread
+    
+    enum { kRetiredPatches = 8 };
+    
+    std::atomic<Patch *> pendingPatch { nullptr };  // prepared, waiting for the audio thread
+    Patch *retired[kRetiredPatches];                // released by the audio thread, to be deleted
+    AbstractFifo retiredFifo { kRetiredPatches };   // queue of retired, written by the audio thread only
+    Patch *currentPatch = nullptr;                  // played by voices, owned by the audio thread
+    
+    double cpuBudget = 0.7;     // fraction of block duration voices may take
+    double detail = 1.;         // fraction of partials rendered by voices
+    bool nonRealtime = false;   // offline rendering is always in full detail
+    int64 measuredTicks = 0;    // render time in governor period
+    int measuredSamples = 0;    // samples rendered in governor period
+    
+    VoiceRenderPool pool;                       // parallel voice rendering
+    OwnedArray<AudioSampleBuffer> voiceBuffers; // output of active voice i
+    Array<SynthesiserVoice *> activeVoices;     // voices rendered by the pool in this block
+    int renderSamples = 0;                      // length of the block rendered by the pool
+    
+    /** Render active voice index into its own buffer, called by the pool. */
+    void render(int index) noexcept override
+    {
+        AudioSampleBuffer &voiceBuffer = *voiceBuffers.getUnchecked(index);
+        
+        voiceBuffer.clear(0, 0, renderSamples);
+        activeVoices.getUnchecked(index)->renderNextBlock(voiceBuffer, 0, renderSamples);
+    }
     
-    void update(Loris::PartialList &partials, double samplePitch)
+    /** Set level of detail of all voices. Audio thread only. */
+    void applyDetail(double newDetail) noexcept
+    {
+        detail = newDetail;
+        
+        LorisVoice *voice;
+        for (int i = voices.size(); --i >= 0;)
+        {
+            voice = dynamic_cast<LorisVoice *>(voices.getUnchecked(i));
+            if (voice)
+                voice->setDetail(detail);
+        }
+    }
+    
+    /**
+       Delete patches released by the audio thread, dataLock has to be locked. It
+       runs before every new pending patch, the audio thread releases one patch per
+       pending one, so at most two are queued at a time.
+     */
+    void deleteRetiredPatches()
+    {
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToRead(retiredFifo.getNumReady(), start1, size1, start2, size2);
+        
+        for (int i = 0; i < size1; i++)
+            delete retired[start1 + i];
+        for (int i = 0; i < size2; i++)
+            delete retired[start2 + i];
+        
+        retiredFifo.finishedRead(size1 + size2);
+    }
+    
+    /**
+       Prepare voices for partials at current sample rate, dataLock has to be locked.
+       @param continuesPrevious true if the partials extend the previous ones.
+     */
+    void update(Loris::PartialList &partials, double samplePitch, bool continuesPrevious)
     {
         Loris::PartialList resampledPartials(partials);
         
@@ -144,14 +459,27 @@ private:
             resampler.quantize(resampledPartials.begin(), resampledPartials.end());
         }
         
+        // one bank for all voices, every voice keeps only its playback state
+        Loris::RealtimePartialBank::Ptr bank =
+            Loris::RealtimePartialBank::create(resampledPartials, Loris::Synthesizer::DefaultParameters().fadeTime, getSampleRate(), availableTime);
+        
+        Patch *patch = new Patch();
+        patch->continuesPrevious = continuesPrevious;
         LorisVoice *voice;
-        int numVoices = getNumVoices();
-        for (int i = 0; i < numVoices; i++)
+        for (int i = 0; i < voices.size(); i++)
         {
-            voice = dynamic_cast<LorisVoice *>(getVoice(i));
-            if (voice)
-                voice->setup(resampledPartials, samplePitch);
+            voice = dynamic_cast<LorisVoice *>(voices.getUnchecked(i));
+            patch->synths.add(voice ? voice->createSynth(bank, samplePitch) : nullptr);
+        }
+        
+        // a patch replacing a pending new sound is a new sound too
+        deleteRetiredPatches();
+        if (Patch *replaced = pendingPatch.exchange(nullptr))
+        {
+            patch->continuesPrevious = patch->continuesPrevious && replaced->continuesPrevious;
+            delete replaced;
         }
+        pendingPatch.store(patch);
     }
     
 };
@@ -37,11 +37,20 @@ static const  int kParameterFrequencyResolution_defaultValue = 40;
 static const char* kParameterReverse_name = "Reverse";
 static const  bool kParameterReverse_defaultValue = false;
 
+static const char* kParameterEmbedPartials_name = "Embed Partials";// store analysed partials in plugin state
+static const  bool kParameterEmbedPartials_defaultValue = false;
+
 static const double kDefaultPitchResolutionRation = 0.8;
 
 static const char* kParameterLastSamplePath_name = "Last Sample Path";
 
 static const int kDefaultSynthesiserVoiceNumbers = 16;// going to be a parameter
+static const int kMaxRenderThreads = 3;// voice rendering workers besides the audio thread
+
+static const char* kParameterRenderThreads_name = "Render Threads";// applied by prepareToPlay()
+static const  int kParameterRenderThreads_minValue = 0;
+static const  int kParameterRenderThreads_maxValue = kMaxRenderThreads;
+static const  int kParameterRenderThreads_defaultValue = 0;// voices render on the audio thread
 
 
 #endif  // PARAMETERDEFITIONS_H_INCLUDED
@@ -42,6 +42,7 @@
 
 #include "../Resources/Resources.h"
 #include "SampleAnalyzer.h"
+#include "SampleReader.h"
 #include "ParameterDefitions.h"
 //[/Headers]
 
@@ -284,19 +285,19 @@ void ParaphrasisAudioProcessorEditor::buttonClicked (Button* buttonThatWasClicke
                 path = sampleFile.getFullPathName().toRawUTF8();
                 parameters.setData(kParameterLastSamplePath_name, path.c_str(), path.length());
 
-                // dectect pitch
-                AudioFormatReader* reader = formatManager.createReaderFor(sampleFile);
-                if (reader)
+                // dectect pitch, only the first channel is needed
+                SampleReader reader(formatManager, sampleFile);
+                if (reader.isOpen())
                 {
-                    detector.setSampleRate(reader->sampleRate);
-                    AudioSampleBuffer buffer(reader->numChannels, reader->lengthInSamples);
-                    reader->read(&buffer, 0, reader->lengthInSamples, 0, true, true);
-                    double pitch = detector.detectPitch(buffer.getWritePointer(0), reader->lengthInSamples);
-
-                    parameters.set(kParameterSamplePitch_name, pitch);
-                    parameters.set(kParameterFrequencyResolution_name, kDefaultPitchResolutionRation * pitch);
-
-                    delete reader;
+                    detector.setSampleRate(reader.getSampleRate());
+                    AudioSampleBuffer buffer(1, (int) reader.getLengthInSamples());
+                    if (reader.read(buffer, 0, buffer.getNumSamples(), 0))
+                    {
+                        double pitch = detector.detectPitch(buffer.getWritePointer(0), buffer.getNumSamples());
+
+                        parameters.set(kParameterSamplePitch_name, pitch);
+                        parameters.set(kParameterFrequencyResolution_name, kDefaultPitchResolutionRation * pitch);
+                    }
                 }
 
             }
@@ -24,6 +24,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "ParameterDefitions.h"
+#include "AnalysisCache.h"
 
 // Loris
 #include "Analyzer.h"
@@ -37,7 +38,7 @@
 ParaphrasisAudioProcessor::ParaphrasisAudioProcessor()
     : TeragonPluginBase(),
       ParameterObserver(),
-      analyzer(formatManager, analyzerSync)
+      analyzer(formatManager, *this)
 {
     // setup parameters
     parameters.add(new teragon::FrequencyParameter(kParameterSamplePitch_name, kParameterSamplePitch_minValue,
@@ -46,6 +47,9 @@ ParaphrasisAudioProcessor::ParaphrasisAudioProcessor()
                                                    kParameterFrequencyResolution_maxValue, kParameterFrequencyResolution_defaultValue));
     parameters.add(new teragon::StringParameter(kParameterLastSamplePath_name));
     parameters.add(new teragon::BooleanParameter(kParameterReverse_name, kParameterReverse_defaultValue));
+    parameters.add(new teragon::BooleanParameter(kParameterEmbedPartials_name, kParameterEmbedPartials_defaultValue));
+    parameters.add(new teragon::IntegerParameter(kParameterRenderThreads_name, kParameterRenderThreads_minValue,
+                                                 kParameterRenderThreads_maxValue, kParameterRenderThreads_defaultValue));
 
     // setup synth
     for (int i = kDefaultSynthesiserVoiceNumbers; --i >= 0;)
@@ -66,22 +70,79 @@ ParaphrasisAudioProcessor::~ParaphrasisAudioProcessor()
 //==============================================================================
 void ParaphrasisAudioProcessor::analyzeSample()
 {
+    // the analyzer is started and completes on the message thread, so a
+    // request can not slip in between its last check and its completion
+    if (! MessageManager::getInstance()->isThisTheMessageThread())
+    {
+        triggerAsyncUpdate();
+        return;
+    }
+    
+    // analyzer parameters can not change while it runs, analyze again later
+    if (analyzer.isThreadRunning())
+    {
+        reanalyze = true;
+        return;
+    }
+    
     // upate analyzer parameters
     analyzer.setSamplePath(parameters[kParameterLastSamplePath_name]->getDisplayText());
     analyzer.setFrequencyResolution(parameters[kParameterFrequencyResolution_name]->getValue());
     analyzer.setPitch(parameters[kParameterSamplePitch_name]->getValue());
     analyzer.setReverse(parameters[kParameterReverse_name]->getValue());
-
-    // analyze
-    analyzer.runThread();
-    analyzerSync.wait();
-    
-    // setup synth
-    double samplePitch = parameters[kParameterSamplePitch_name]->getValue();
     
+    // analyze, the previous sound plays meanwhile
+    analyzer.launchThread();
+}
+
+//==============================================================================
+void ParaphrasisAudioProcessor::analysisProgressed(SampleAnalyzer &analyzer, Loris::PartialList &partials, double availableTime)
+{
+    // play the beginning of the sample while the rest is being analysed
+    if (progressing)
+    {
+        synth.extend(partials, availableTime);
+    }
+    else
+    {
+        progressing = true;
+        m_isReady = true;
+        synth.setup(partials, analyzer.pitch(), availableTime);
+    }
+}
+
+//==============================================================================
+void ParaphrasisAudioProcessor::analysisPreviewed(SampleAnalyzer &analyzer, double availableTime)
+{
+    // play the coarse sound until the full analysis replaces it; it is not complete,
+    // so it is never stored in the plugin state
+    m_isReady = analyzer.partials().empty() == false;
+    synth.setup(analyzer.partials(), analyzer.pitch(), availableTime);
+}
+
+//==============================================================================
+void ParaphrasisAudioProcessor::analysisFinished(SampleAnalyzer &analyzer)
+{
+    // setup synth, it hands the new sound to the audio thread
     m_isReady = analyzer.partials().empty() == false;
     
-    synth.setup(analyzer.partials(), samplePitch);// partials will be moved from analyzer to synth
+    // partials will be moved from analyzer to synth
+    if (progressing)
+        synth.extend(analyzer.partials());
+    else
+        synth.setup(analyzer.partials(), analyzer.pitch());
+    
+    progressing = false;
+}
+
+//==============================================================================
+void ParaphrasisAudioProcessor::analysisCompleted(SampleAnalyzer &/*analyzer*/)
+{
+    if (reanalyze.exchange(false))
+    {
+        analyzeSample();
+        return;
+    }
     
     // indicate analysis state
     ParaphrasisAudioProcessorEditor* editor = dynamic_cast<ParaphrasisAudioProcessorEditor *>(getActiveEditor());
@@ -89,6 +150,12 @@ void ParaphrasisAudioProcessor::analyzeSample()
         editor->lightOn( m_isReady );
 }
 
+//==============================================================================
+void ParaphrasisAudioProcessor::handleAsyncUpdate()
+{
+    analyzeSample();
+}
+
 //==============================================================================
 void ParaphrasisAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
@@ -101,7 +168,12 @@ void ParaphrasisAudioProcessor::prepareToPlay(double sampleRate, int samplesPerB
     // prepareToPlay(). Your code must be able to cope with variable-sized blocks,
     // or you're going to get clicks and crashes!
     TeragonPluginBase::prepareToPlay(sampleRate, samplesPerBlock);
+    synth.setMaxBlockSize(samplesPerBlock);
     synth.setCurrentPlaybackSampleRate(sampleRate);
+    
+    // parallel rendering is opt-in, leave one core to the host
+    const int renderThreads = (int) parameters[kParameterRenderThreads_name]->getValue();
+    synth.setRenderThreads(jmin(renderThreads, SystemStats::getNumCpus() - 1), samplesPerBlock);
 }
 
 
@@ -111,6 +183,7 @@ void ParaphrasisAudioProcessor::releaseResources()
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
     TeragonPluginBase::releaseResources();
+    synth.setRenderThreads(0, 0);
 }
 
 //==============================================================================
@@ -119,9 +192,62 @@ void ParaphrasisAudioProcessor::onParameterUpdated(const Parameter *parameter)
 
 }
 
+//==============================================================================
+static const int kEmbeddedPartialsMagic = 0x4c505050;  // "PPPL"
+
+/**
+ Read partials embedded at the end of plugin state, they are followed by
+ their size and kEmbeddedPartialsMagic.
+ */
+static bool readEmbeddedPartials(const void *data, int sizeInBytes, Loris::PartialList &partials)
+{
+    const char *bytes = static_cast<const char *>(data);
+    
+    if (sizeInBytes < 8 || (int) ByteOrder::littleEndianInt(bytes + sizeInBytes - 4) != kEmbeddedPartialsMagic)
+        return false;
+    
+    const int size = (int) ByteOrder::littleEndianInt(bytes + sizeInBytes - 8);
+    if (size <= 0 || size > sizeInBytes - 8)
+        return false;
+    
+    MemoryInputStream compressed(bytes + sizeInBytes - 8 - size, (size_t) size, false);
+    GZIPDecompressorInputStream input(compressed);
+    
+    return AnalysisCache::readPartials(input, partials);
+}
+
+//==============================================================================
+void ParaphrasisAudioProcessor::getStateInformation(MemoryBlock &destData)
+{
+    TeragonPluginBase::getStateInformation(destData);
+    
+    if (parameters[kParameterEmbedPartials_name]->getValue() == false)
+        return;
+    
+    Loris::PartialList partials;
+    synth.getPartials(partials);
+    if (partials.empty())
+        return;
+    
+    // partials follow the parameters, older versions read only the parameters
+    MemoryOutputStream output(destData, true);
+    const int64 start = output.getPosition();
+    {
+        GZIPCompressorOutputStream compressor(&output, 9);
+        AnalysisCache::writePartials(compressor, partials);
+    }
+    output.writeInt((int) (output.getPosition() - start));
+    output.writeInt(kEmbeddedPartialsMagic);
+}
+
 //==============================================================================
 void ParaphrasisAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
+    // embedded partials are used instead of analysing the sample again
+    Loris::PartialList partials;
+    if (readEmbeddedPartials(data, sizeInBytes, partials))
+        analyzer.setPreparedPartials(partials);
+    
     TeragonPluginBase::setStateInformation(data, sizeInBytes);
     analyzeSample();// reload sample when state information changes (possible path change)
 }
@@ -140,8 +266,10 @@ void ParaphrasisAudioProcessor::processBlock(AudioSampleBuffer& buffer, MidiBuff
 		buffer.clear(i, 0, buffer.getNumSamples());
 	}
     
-    // synthesise
+    // synthesise, bounces are rendered in full detail
     const int numSamples = buffer.getNumSamples();
+    synth.setNonRealtime(isNonRealtime());
+    synth.applyPendingPatch();
     synth.renderNextBlock(buffer, midiMessages, 0, numSamples);
     
     // copy first channel to other(s) (synth is mono)
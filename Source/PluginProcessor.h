@@ -38,7 +38,7 @@ using namespace teragon;
 /**
  Paraphrasis processor class. 
 */
-class ParaphrasisAudioProcessor  : public TeragonPluginBase, ParameterObserver
+class ParaphrasisAudioProcessor  : public TeragonPluginBase, ParameterObserver, SampleAnalyzer::Listener, AsyncUpdater
 {
 
 public:
@@ -55,6 +55,9 @@ public:
     void releaseResources() override;
     void processBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
     
+    /** Store parameters and, if Embed Partials is on, analysed partials compressed. */
+    virtual void getStateInformation(MemoryBlock &destData) override;
+    /** Restore parameters, embedded partials are used instead of analysing the sample. */
     virtual void setStateInformation(const void *data, int sizeInBytes) override;
 
     // PluginParameterObserver methods
@@ -62,6 +65,10 @@ public:
     virtual void onParameterUpdated(const Parameter *parameter) override;
 
     // my methods
+    /**
+     Start analysis of the sample, returns immediately. The previous sound plays until it is done.
+     Called from another thread than the message one, it starts the analysis from there later.
+     */
     void analyzeSample();
 
     /** Is processor (analysis data) ready for synthesis? */
@@ -71,13 +78,23 @@ public:
     }
 
 private:
+    // SampleAnalyzer::Listener methods
+    void analysisProgressed(SampleAnalyzer &analyzer, Loris::PartialList &partials, double availableTime) override;
+    void analysisPreviewed(SampleAnalyzer &analyzer, double availableTime) override;
+    void analysisFinished(SampleAnalyzer &analyzer) override;
+    void analysisCompleted(SampleAnalyzer &analyzer) override;
+    
+    // AsyncUpdater method, analyzeSample() called from another thread
+    void handleAsyncUpdate() override;
+    
     String loadedSamplePath;    // Path to actual data
-    bool m_isReady = false;     // Is processor (analysis data) ready for synthesis?
+    std::atomic<bool> m_isReady { false };      // Is processor (analysis data) ready for synthesis?
+    std::atomic<bool> reanalyze { false };      // Sample changed during analysis, analyze again when it finishes
+    std::atomic<bool> progressing { false };    // Synth plays partials of the running analysis
 
     // the synth!
     LorisSynthesiser synth;     // Loris wrapper
     SampleAnalyzer analyzer;    // Data analyzer and loader
-    WaitableEvent analyzerSync; // Wait for analyzer to finish
 
     AudioFormatManager  formatManager; // For loading input data (audio files)
     //==============================================================================
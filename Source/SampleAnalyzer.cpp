@@ -22,18 +22,33 @@
  */
 
 #include "SampleAnalyzer.h"
+#include "SampleReader.h"
 
-#include "Analyzer.h"
 #include "Channelizer.h"
 #include "Distiller.h"
+#include "FourierTransform.h"
 #include "PartialUtils.h"
+#include "phasefix.h"
 #include "SdifFile.h"
 #include "PartialUtils.h" 
 
-SampleAnalyzer::SampleAnalyzer(AudioFormatManager &formatManager, WaitableEvent& syncObj, const String &name)
+static const double kPreviewMinSeconds = 2.;        // shorter samples are analysed progressively
+static const double kPreviewBudgetSec = 0.25;       // wall time the preview may take
+static const double kPreviewMinSampleRate = 11025.; // preview decimates down to this rate at most
+static const double kPreviewHopScale = 2.;          // preview frames are this many times further apart
+
+/** Return file keeping the FFT plans measured by FFTW between sessions. */
+static File getFftWisdomFile()
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+                .getChildFile("Paraphrasis").getChildFile("fftw-wisdom");
+}
+
+//==============================================================================
+SampleAnalyzer::SampleAnalyzer(AudioFormatManager &formatManager, Listener &listener, const String &name)
     : ThreadWithProgressWindow(name, false, false),
       formatManager(formatManager),
-      analyzerSync(syncObj)
+      listener(listener)
 {
 
 }
@@ -46,11 +61,22 @@ SampleAnalyzer::~SampleAnalyzer()
 //==============================================================================
 void SampleAnalyzer::run() noexcept
 {
-    buffer.clear();
-    sampleRate = 0;
+    m_partials.clear();
+    publishedOnsets.clear();
+    publishedTime = 0;
+    previewTime = 0;
+    
+    {
+        const ScopedLock sl(preparedLock);
+        m_partials.swap(preparedPartials);
+    }
     
     //TODO: loading should be controlled by exceptions not by bool functions...
-    if ( !m_samplePath.isEmpty() )
+    if ( !m_partials.empty() )
+    {
+        // restored partials were post processed before they were stored
+    }
+    else if ( !m_samplePath.isEmpty() )
     {
 #ifdef ENABLE_SDIF_FILES
         if (File(m_samplePath).getFileExtension().toUpperCase() == ".SDIF")
@@ -60,16 +86,41 @@ void SampleAnalyzer::run() noexcept
         }
         else
 #endif
-            if ( loadAudioFile() )
-        {
-            postProcessPartials();
-        }
-        else
         {
-             NativeMessageBox::showMessageBoxAsync(AlertWindow::WarningIcon, "Ooops...", "Paraphrasis can not load file, sorry...");
+            setStatusMessage("Reading analysis cache...");
+            const String cacheKey(AnalysisCache::makeKey(File(m_samplePath), m_resolution, m_pitch, reverse));
+            
+            if (cacheKey.isNotEmpty() && cache.load(cacheKey, m_partials))
+            {
+                // partials were post processed before they were stored
+            }
+            else if ( loadAudioFile() )
+            {
+                postProcessPartials();
+                cache.store(cacheKey, m_partials);
+            }
+            else
+            {
+                 NativeMessageBox::showMessageBoxAsync(AlertWindow::WarningIcon, "Ooops...", "Paraphrasis can not load file, sorry...");
+            }
         }
     }
-    analyzerSync.signal();
+    listener.analysisFinished(*this);
+}
+
+//==============================================================================
+void SampleAnalyzer::threadComplete(bool /*userPressedCancel*/)
+{
+    listener.analysisCompleted(*this);
+}
+
+//==============================================================================
+void SampleAnalyzer::setPreparedPartials(Loris::PartialList &partials) noexcept
+{
+    const ScopedLock sl(preparedLock);
+    
+    preparedPartials.clear();
+    preparedPartials.swap(partials);
 }
 
 //==============================================================================
@@ -94,8 +145,10 @@ void SampleAnalyzer::postProcessPartials() noexcept
 {
     setStatusMessage("Processing partials...");
 
-    // partials in partial list will be sorted by start time
+    // partials in partial list will be sorted by start time, published ones keep their positions
     m_partials.sort(Loris::PartialUtils::compareStartTimeLess());
+    if (!publishedOnsets.empty())
+        orderLikePublished(m_partials);
         
     // chanelize - mark partial - not needed now
     Loris::Channelizer channelizer(m_pitch);
@@ -106,74 +159,278 @@ void SampleAnalyzer::postProcessPartials() noexcept
 }
 
 //==============================================================================
-bool SampleAnalyzer::loadAudioFile() noexcept
+bool SampleAnalyzer::Onset::operator<(const Onset &other) const noexcept
+{
+    if (time != other.time)
+        return time < other.time;
+    if (amplitude != other.amplitude)
+        return amplitude < other.amplitude;
+    return phase < other.phase;
+}
+
+SampleAnalyzer::Onset SampleAnalyzer::Onset::of(const Loris::Partial &partial)
 {
-    AudioFormatReader* reader = formatManager.createReaderFor (File(m_samplePath));
+    const Loris::Breakpoint &first = partial.first();
+    return { partial.startTime(), first.amplitude(), first.phase() };
+}
+
+//==============================================================================
+void SampleAnalyzer::publishPartials(const Loris::PartialList &complete, const Loris::PartialList &building, double time)
+{
+    Loris::PartialList partials(complete);
     
-    if (reader == nullptr)
+    // copies of partials being built are fixed like the complete ones
+    for (const Loris::Partial &partial : building)
     {
-        return false;
+        partials.push_back(partial);
+        Loris::fixFrequency(partials.back());
     }
     
-    // check if user really wants to load a long sample
-    if (reader->lengthInSamples / reader->sampleRate > 20)
+    orderLikePublished(partials);
+    publishedTime = time;
+    
+    listener.analysisProgressed(*this, partials, time);
+}
+
+//==============================================================================
+void SampleAnalyzer::orderLikePublished(Loris::PartialList &partials)
+{
+    // partials are never removed during analysis, every published one is found
+    std::vector<Loris::PartialList::iterator> published(publishedOnsets.size(), partials.end());
+    Loris::PartialList others;
+    
+    for (Loris::PartialList::iterator it = partials.begin(); it != partials.end();)
     {
-        bool result = NativeMessageBox::showOkCancelBox(AlertWindow::QuestionIcon, "Do you...?", "Do you REALLY want to load sample longer than 20 sec?");
+        Loris::PartialList::iterator next = std::next(it);
+        std::map<Onset, int>::const_iterator found = publishedOnsets.find(Onset::of(*it));
         
-        if ( !result )
+        if (found != publishedOnsets.end())
+            published[found->second] = it;
+        else
+            others.splice(others.end(), partials, it);
+        
+        it = next;
+    }
+    
+    Loris::PartialList ordered;
+    for (size_t i = 0; i < published.size(); ++i)
+        if (published[i] != partials.end())
+            ordered.splice(ordered.end(), partials, published[i]);
+    
+    for (const Loris::Partial &partial : others)
+        publishedOnsets.insert(std::make_pair(Onset::of(partial), (int) publishedOnsets.size()));
+    
+    ordered.splice(ordered.end(), others);
+    ordered.splice(ordered.end(), partials);   // duplicate onsets, if any
+    partials.swap(ordered);
+}
+
+//==============================================================================
+/**
+ Feeds the analyzer with samples of an audio file read chunk by chunk, so that
+ only one chunk of the file is in memory (or mapped). Stereo is mixed down to mono
+ and reversed sample is read from its end chunk by chunk, neither copies the file.
+ Float samples that are not decimated are read straight into the buffer of the
+ analyzer, others go through the chunk.
+ */
+template <typename SampleType>
+class SampleAnalyzer::ReaderSource : public Loris::Analyzer::BasicSampleSource<SampleType>
+{
+public:
+    /**
+     @param decimation every this many samples are averaged into one.
+     @param deadline the source ends at this Time::getMillisecondCounterHiRes(), 0 for never.
+     @param publish hand partials found so far to the owner while analysing.
+     */
+    ReaderSource(SampleReader &reader, bool reverse, SampleAnalyzer &owner,
+                 int decimation = 1, double deadline = 0, bool publish = true)
+        : reader(reader),
+          reverse(reverse),
+          owner(owner),
+          decimation(decimation),
+          deadline(deadline),
+          publish(publish),
+          chunk(2, kChunkSamples)
+    {
+    
+    }
+    
+    long read(SampleType *samples, long maxSamples) override
+    {
+        if (deadline > 0 && Time::getMillisecondCounterHiRes() > deadline)
+            return 0;
+        
+        // whole groups of decimated samples, except at the end of the file
+        const int numSamples = (int) jmin((int64) maxSamples * decimation, (int64) (kChunkSamples / decimation * decimation),
+                                          reader.getLengthInSamples() - position);
+        
+        if (numSamples <= 0)
+            return 0;
+        
+        // the left channel is read where the mono samples go
+        float *mono = directBuffer(samples);
+        const bool direct = (mono != nullptr);
+        if (!direct)
+            mono = chunk.getWritePointer(0);
+        
+        float *channels[] = { mono, chunk.getWritePointer(1) };
+        AudioSampleBuffer buffer(channels, 2, numSamples);
+        
+        const int64 start = reverse ? reader.getLengthInSamples() - position - numSamples : position;
+        if (!reader.read(buffer, 0, numSamples, start))
         {
-            delete reader;
-            return false;
+            // the analysis ends here like at the end of the file, the owner checks hasFailed()
+            failed = true;
+            return 0;
+        }
+        
+        // reverse
+        if (reverse)
+            buffer.reverse(0, numSamples);
+        
+        const float *left = buffer.getReadPointer(0);
+        const float *right = buffer.getReadPointer(1);
+        
+        // stereo -> mono
+        if (reader.getNumChannels() == 2)
+        {
+            // huh strange stereo to mono algorith which seems to be working...
+            // credits or inspiration: http://www.dsprelated.com/showmessage/106421/2.php
+            for (int i = 0; i < numSamples; i++)
+                mono[i] = std::max(left[i], right[i]);
+        }
+        
+        // decimate, averaging is a crude lowpass but good enough for a preview
+        const int numDecimated = (numSamples + decimation - 1) / decimation;
+        // samples read directly are in place already
+        if (!direct)
+        {
+            for (int i = 0; i < numDecimated; i++)
+            {
+                const int first = i * decimation;
+                const int last = jmin(first + decimation, numSamples);
+                
+                double sum = 0;
+                for (int j = first; j < last; j++)
+                    sum += mono[j];
+                
+                samples[i] = (SampleType) (sum / (last - first));
+            }
         }
+        
+        position += numSamples;
+        owner.setProgress((double) position / (double) reader.getLengthInSamples());
+        
+        return numDecimated;
     }
     
-    // read samples
-    setStatusMessage("Reading file...");
-    AudioSampleBuffer fileSamples(2, reader->lengthInSamples);
-    reader->read(&fileSamples, 0, reader->lengthInSamples, 0, true, true);
+    /** Return true if the sample could not be read, the analysis ended early then. */
+    bool hasFailed() const noexcept
+    {
+        return failed;
+    }
     
-    // reverse
-    if (reverse)
-        fileSamples.reverse(0, reader->lengthInSamples);
+    /** Return the time in seconds up to which the sample has been read. */
+    double readTime() const noexcept
+    {
+        return (double) position / reader.getSampleRate();
+    }
     
-    // mono -> stereo
-    if (reader->numChannels == 2 && fileSamples.getNumChannels() == 2)
+    void analyzed(const Loris::PartialList &complete, const Loris::PartialList &building, double time) override
     {
-        // huh strange stereo to mono algorith which seems to be working...
-        // credits or inspiration: http://www.dsprelated.com/showmessage/106421/2.php
-        int64 numSamples = fileSamples.getNumSamples();
-        for (int i = 0; i < numSamples; i++)
+        // every publication copies all partials, publish when the available time doubles
+        if (publish && time > owner.previewTime && time >= 2. * owner.publishedTime)
+            owner.publishPartials(complete, building, time);
+    }
+    
+private:
+    static const int kChunkSamples = 65536;
+    
+    /** Return where float samples can be read directly, nullptr if they can not. */
+    float* directBuffer(float *samples) const noexcept      { return decimation == 1 ? samples : nullptr; }
+    float* directBuffer(double *) const noexcept            { return nullptr; }
+    
+    SampleReader &reader;
+    const bool reverse;
+    SampleAnalyzer &owner;
+    const int decimation;
+    const double deadline;
+    const bool publish;
+    AudioSampleBuffer chunk;
+    int64 position = 0;
+    bool failed = false;
+};
+
+//==============================================================================
+bool SampleAnalyzer::loadAudioFile() noexcept
+{
+    SampleReader reader(formatManager, File(m_samplePath));
+    
+    if (!reader.isOpen())
+    {
+        return false;
+    }
+    
+    // long samples are previewed first, a full analysis would keep the user waiting
+    if (previewEnabled && reader.getLengthInSamples() > kPreviewMinSeconds * reader.getSampleRate())
+    {
+        setStatusMessage("Previewing sample...");
+        
+        // single precision is accurate enough for a preview and faster
+        const int decimation = jmax(1, (int) (reader.getSampleRate() / kPreviewMinSampleRate));
+        ReaderSource<float> preview(reader, reverse, *this, decimation,
+                                    Time::getMillisecondCounterHiRes() + 1000. * kPreviewBudgetSec, false);
+        analyze(preview, reader.getSampleRate() / decimation, kPreviewHopScale);
+        
+        if (preview.hasFailed())
         {
-            *fileSamples.getWritePointer(0, i) = std::max(*fileSamples.getReadPointer(0, i), *fileSamples.getReadPointer(1, i));
+            m_partials.clear();
+            return false;
         }
+        
+        postProcessPartials();
+        previewTime = preview.readTime();
+        listener.analysisPreviewed(*this, previewTime);
+        m_partials.clear();
     }
     
-    // delete reader ASAP so we dont forget and prevent memory leaks
-    int64 lengthInSamples = reader->lengthInSamples;
-    sampleRate = reader->sampleRate;
-    delete reader;
-    reader = nullptr;
+    // samples are streamed into the analysis, the length of the file does not matter;
+    // the preview plays until the full analysis covers more of the sample
+    setStatusMessage("Anayzing sample...");
+    ReaderSource<double> source(reader, reverse, *this);
+    analyze(source, reader.getSampleRate());
     
-    // transform data from JUCE to Loris (from float to double)
-    buffer.reserve(lengthInSamples);
-    const float *sample = fileSamples.getReadPointer(0);
-    for (int i = 0; i < lengthInSamples; i++)
+    // partials of a sample read only in part are not a result, they must not be cached
+    if (source.hasFailed())
     {
-        buffer.push_back(sample[i]);
+        m_partials.clear();
+        return false;
     }
     
-    analyze();
-    
     return true;
 }
 
 //==============================================================================
-void SampleAnalyzer::analyze() noexcept
+template <typename SampleType>
+void SampleAnalyzer::analyze(Loris::Analyzer::BasicSampleSource<SampleType> &source, double sampleRate, double hopScale) noexcept
 {
-    // analyze
-    setStatusMessage("Anayzing sample...");
+    // measuring FFT plans is slow, reuse the ones of previous sessions
+    static const bool wisdomLoaded = Loris::FourierTransformPlans::usesWisdom()
+                                     && Loris::FourierTransformPlans::loadWisdom(getFftWisdomFile().getFullPathName().toStdString());
+    (void) wisdomLoaded;
+    const unsigned long plans = Loris::FourierTransformPlans::numPlans();
+
     Loris::Analyzer analyzer(m_resolution);
-    analyzer.analyze(buffer, sampleRate);
+    analyzer.setHopTime(analyzer.hopTime() * hopScale);
+    analyzer.setNumThreads(numThreads);
+    analyzer.analyze(source, sampleRate);
+
+    if (Loris::FourierTransformPlans::usesWisdom() && Loris::FourierTransformPlans::numPlans() != plans)
+    {
+        const File wisdom(getFftWisdomFile());
+        if (wisdom.getParentDirectory().createDirectory())
+            Loris::FourierTransformPlans::saveWisdom(wisdom.getFullPathName().toStdString());
+    }
     
     m_partials.clear();
     m_partials = std::move(analyzer.partials());
@@ -24,27 +24,66 @@
 #define SAMPLE_ANALYZER_H_INCLUDED
 
 #include "JuceHeader.h"
+#include "AnalysisCache.h"
+#include "Analyzer.h"
 #include "ParameterDefitions.h"
 #include "PartialList.h"
 
+#include <map>
+
 /**
  Sample analyzer reads audio files and converts it into Loris::PartialList. It can reverse loaded sample.
- Analysis runs in another thread.
+ Analysis runs in another thread, start it by launchThread(), the caller does not wait.
+ Analysed partials are kept in an AnalysisCache, unchanged files are not analysed again.
+ While an audio file is analysed the partials found so far are published, so the
+ beginning of the sample can be played before the analysis finishes.
  */
 class SampleAnalyzer : public ThreadWithProgressWindow
 {
 public:
+    /** Receives results of the analysis. */
+    class Listener
+    {
+    public:
+        virtual ~Listener() {}
+        
+        /**
+         Called from the analysis thread while a sample is being analysed, with the
+         partials found so far. They are complete up to availableTime seconds, later
+         calls append breakpoints after it and add partials starting after it. Partials
+         passed before come first, in the same order, partials() keep the order too.
+         */
+        virtual void analysisProgressed(SampleAnalyzer &analyzer, Loris::PartialList &partials, double availableTime) = 0;
+        
+        /**
+         Called from the analysis thread when a coarse preview of the sample is in
+         partials(), they can be taken. The preview covers the sample up to
+         availableTime seconds only. The analysis goes on in full quality, partials
+         are passed to analysisProgressed() once they cover more than the preview,
+         analysisFinished() follows.
+         */
+        virtual void analysisPreviewed(SampleAnalyzer &analyzer, double availableTime) = 0;
+        
+        /** Called from the analysis thread when partials() are ready (possibly empty). */
+        virtual void analysisFinished(SampleAnalyzer &analyzer) = 0;
+        
+        /** Called from the message thread when the analysis thread has finished. */
+        virtual void analysisCompleted(SampleAnalyzer &analyzer) = 0;
+    };
+    
     /**
      Create new SampleAnalyzer object.
      @param formatManager format manager object for loading audio files.
-     @param syncObj sinalize when thread/analysis is finished.
+     @param listener receives results of the analysis.
      */
-    SampleAnalyzer(AudioFormatManager &formatManager, WaitableEvent &syncObj, const String &name = "Paraphrasis is loading...");
+    SampleAnalyzer(AudioFormatManager &formatManager, Listener &listener, const String &name = "Paraphrasis is loading...");
     virtual ~SampleAnalyzer();
     
-    /** Start the analysis thread. When analysis is finished WitableEvent passed in constructor is signaled. */
+    /** Analysis thread. When analysis is finished the listener passed in constructor is called. */
     void run() noexcept override;
     
+    void threadComplete(bool userPressedCancel) override;
+    
     void setSamplePath(const String & path) noexcept            { this->m_samplePath = path; }
     String samplePath()  noexcept                               { return m_samplePath; }
     
@@ -56,30 +95,85 @@ public:
     
     void setReverse(bool reverse) noexcept                      { this->reverse = reverse; }
     
+    /**
+     Preview long samples before analysing them in full quality. The preview
+     analyses decimated samples in single precision with longer hop and shorter
+     window (fewer bins) within a fixed time budget, samples after are left out.
+     The full analysis is in double precision. Enabled by default.
+     */
+    void setPreviewEnabled(bool enabled) noexcept               { this->previewEnabled = enabled; }
+    bool isPreviewEnabled() const noexcept                      { return previewEnabled; }
+    
+    /**
+     Threads computing spectra of a sample concurrently, 1 analyses on the analysis
+     thread only, 0 (the default) uses the hardware threads, at most
+     Loris::Analyzer::DefaultMaxThreads. Partials do not depend on it.
+     */
+    void setNumThreads(int numThreads) noexcept                 { this->numThreads = jmax(0, numThreads); }
+    int getNumThreads() const noexcept                          { return numThreads; }
+    
     Loris::PartialList& partials() noexcept                     { return m_partials; }
     
+    /**
+     Use partials instead of loading the sample in the next run(), e.g. partials
+     restored from plugin state. They are moved, not copied.
+     */
+    void setPreparedPartials(Loris::PartialList &partials) noexcept;
+    
 private:
     
-    /** Read file specified by samplePath using formatManager passed in constructor */
+    /**
+     Read and analyse file specified by samplePath using formatManager passed in constructor.
+     @return false if the file can not be opened or read to its end, partials are empty then.
+     */
     bool loadAudioFile() noexcept;
-    /** Analyse loaded sampes. */
-    void analyze() noexcept;
+    /**
+     Analyse samples read from source, in the precision of its samples.
+     @param hopScale multiplies hop time of the analyzer, greater is faster and coarser.
+     */
+    template <typename SampleType>
+    void analyze(Loris::Analyzer::BasicSampleSource<SampleType> &source, double sampleRate, double hopScale = 1.) noexcept;
     /** Read SDIF file using Loris. */
     bool loadSdif() noexcept;
     /** Fix phases and order partials by time. */
     void postProcessPartials() noexcept;
+    /** Hand partials found so far to the listener, see Listener::analysisProgressed(). */
+    void publishPartials(const Loris::PartialList &complete, const Loris::PartialList &building, double time);
+    /** Put published partials to their positions, the other ones after them. */
+    void orderLikePublished(Loris::PartialList &partials);
+    
+    /** Reads float or double samples for the analysis. */
+    template <typename SampleType>
+    class ReaderSource;
+    
+    /** Start time and first breakpoint of a partial, they do not change while it is analysed. */
+    struct Onset
+    {
+        double time, amplitude, phase;
+        
+        /** Return onset of a partial having breakpoints. */
+        static Onset of(const Loris::Partial &partial);
+        
+        bool operator<(const Onset &other) const noexcept;
+    };
     
     String m_samplePath;
     double m_resolution = kParameterFrequencyResolution_defaultValue;
     double m_pitch      = kParameterSamplePitch_defaultValue;
     bool reverse        = false;
+    bool previewEnabled = true;
+    int numThreads      = 0;
     
     AudioFormatManager& formatManager;
-    WaitableEvent& analyzerSync;
+    Listener& listener;
+    AnalysisCache cache;
     
     Loris::PartialList m_partials;
-    std::vector<double> buffer;
-    double sampleRate = 0;
+    Loris::PartialList preparedPartials;   // used instead of the sample by the next run()
+    CriticalSection preparedLock;
+    std::map<Onset, int> publishedOnsets;   // positions of partials published during analysis
+    double publishedTime = 0;               // available time of the last published partials
+    double previewTime = 0;                 // time covered by the preview, full partials are published after it
     
 };
 
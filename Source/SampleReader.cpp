@@ -0,0 +1,60 @@
+/*
+ This is Paraphrasis synthesiser.
+
+ Copyright (c) 2026 by the Paraphrasis contributors
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY, without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ */
+
+#include "SampleReader.h"
+
+//==============================================================================
+SampleReader::SampleReader(AudioFormatManager &formatManager, const File &file)
+{
+    if (AudioFormat *format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+    {
+        mappedReader = format->createMemoryMappedReader(file);
+        reader = mappedReader;
+    }
+
+    if (reader == nullptr)
+        reader = formatManager.createReaderFor(file);
+}
+
+//==============================================================================
+bool SampleReader::read(AudioSampleBuffer &buffer, int startSample, int numSamples, int64 readerStartSample)
+{
+    if (mappedReader == nullptr)
+    {
+        reader->read(&buffer, startSample, numSamples, readerStartSample, true, true);
+        return true;
+    }
+
+    // map one section after another, the mapped pages are released when the next one is mapped
+    for (int done = 0; done < numSamples;)
+    {
+        const int num = jmin(numSamples - done, kSectionSamples);
+        const Range<int64> section(readerStartSample + done, readerStartSample + done + num);
+
+        if (!mappedReader->getMappedSection().contains(section) && !mappedReader->mapSectionOfFile(section))
+            return false;
+
+        reader->read(&buffer, startSample + done, num, section.getStart(), true, true);
+        done += num;
+    }
+
+    return true;
+}
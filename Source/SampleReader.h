@@ -0,0 +1,70 @@
+/*
+ This is Paraphrasis synthesiser.
+
+ Copyright (c) 2026 by the Paraphrasis contributors
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY, without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ */
+#ifndef SAMPLEREADER_H_INCLUDED
+#define SAMPLEREADER_H_INCLUDED
+
+#include "JuceHeader.h"
+
+/**
+ Reads samples of an audio file, for the pitch detection and the analysis.
+
+ Uncompressed formats (WAV, AIFF) are memory mapped, samples are converted
+ straight from the mapped file into the destination buffer, there is no stream
+ buffer in between. Only the section being read is mapped, so reading a long
+ file does not keep it all resident. Other formats are read by the reader of
+ the format manager.
+ */
+class SampleReader
+{
+public:
+    /**
+     Open audio file.
+     @param formatManager format manager object for creating readers.
+     @param file the audio file, isOpen() is false if it can not be read.
+     */
+    SampleReader(AudioFormatManager &formatManager, const File &file);
+
+    bool isOpen() const noexcept                    { return reader != nullptr; }
+    bool isMemoryMapped() const noexcept            { return mappedReader != nullptr; }
+
+    double getSampleRate() const noexcept           { return reader->sampleRate; }
+    int64 getLengthInSamples() const noexcept       { return reader->lengthInSamples; }
+    int getNumChannels() const noexcept             { return (int) reader->numChannels; }
+
+    /**
+     Read samples of the first two channels (of the first one if buffer has one channel),
+     see AudioFormatReader::read().
+     @return false if the file could not be mapped.
+     */
+    bool read(AudioSampleBuffer &buffer, int startSample, int numSamples, int64 readerStartSample);
+
+private:
+    static const int kSectionSamples = 65536;   // mapped at once
+
+    ScopedPointer<AudioFormatReader> reader;
+    MemoryMappedAudioFormatReader *mappedReader = nullptr;    // reader, if the file is memory mapped
+
+    JUCE_DECLARE_NON_COPYABLE (SampleReader)
+};
+
+
+
+#endif  // SAMPLEREADER_H_INCLUDED
@@ -0,0 +1,239 @@
+/*
+ This is Paraphrasis synthesiser.
+
+ Copyright (c) 2026 by the Paraphrasis contributors
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY, without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ */
+
+#include "VoiceRenderPool.h"
+
+#if JUCE_INTEL
+ #include <xmmintrin.h>
+#endif
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+ #include <errno.h>
+#endif
+
+static const int kWorkerPriority = 9;       // realtime, just below the audio thread
+
+/** Tell the CPU we are spinning. */
+static inline void spinPause() noexcept
+{
+   #if JUCE_INTEL
+    _mm_pause();
+   #endif
+}
+
+//==============================================================================
+/**
+ Counting semaphore whose signal() and wait() are one atomic operation unless
+ the waiting thread has to sleep. Only then the system semaphore (a futex on
+ Linux) is used, signal() never takes a lock.
+ */
+class WakeSemaphore
+{
+public:
+    WakeSemaphore()
+    {
+        count = 0;
+       #if JUCE_MAC || JUCE_IOS
+        semaphore = dispatch_semaphore_create(0);
+       #elif JUCE_WINDOWS
+        semaphore = CreateSemaphore(nullptr, 0, 0x7fffffff, nullptr);
+       #else
+        sem_init(&semaphore, 0, 0);
+       #endif
+    }
+
+    ~WakeSemaphore()
+    {
+       #if JUCE_MAC || JUCE_IOS
+        dispatch_release(semaphore);
+       #elif JUCE_WINDOWS
+        CloseHandle(semaphore);
+       #else
+        sem_destroy(&semaphore);
+       #endif
+    }
+
+    void signal() noexcept
+    {
+        if (count.fetch_add(1, std::memory_order_release) < 0)
+        {
+           #if JUCE_MAC || JUCE_IOS
+            dispatch_semaphore_signal(semaphore);
+           #elif JUCE_WINDOWS
+            ReleaseSemaphore(semaphore, 1, nullptr);
+           #else
+            sem_post(&semaphore);
+           #endif
+        }
+    }
+
+    void wait() noexcept
+    {
+        if (count.fetch_sub(1, std::memory_order_acquire) > 0)
+            return;
+
+       #if JUCE_MAC || JUCE_IOS
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+       #elif JUCE_WINDOWS
+        WaitForSingleObject(semaphore, INFINITE);
+       #else
+        while (sem_wait(&semaphore) != 0 && errno == EINTR)
+            ;
+       #endif
+    }
+
+private:
+    std::atomic<int> count;             // negative while threads sleep
+   #if JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_WINDOWS
+    HANDLE semaphore;
+   #else
+    sem_t semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE(WakeSemaphore)
+};
+
+//==============================================================================
+/** Worker thread, sleeps until run() wakes it and then renders jobs of the current run. */
+class VoiceRenderPool::Worker : public Thread
+{
+public:
+    Worker(VoiceRenderPool &pool, int index)
+        : Thread("Paraphrasis voice renderer " + String(index)),
+          pool(pool)
+    {
+    }
+
+    void run() override
+    {
+        for (;;)
+        {
+            wakeUp.wait();
+            if (threadShouldExit())
+                return;
+
+            // a late wake up finds no jobs left, the audio thread rendered them
+            pool.renderJobs();
+        }
+    }
+
+    /** Wake the worker to help with the current run. */
+    void wake() noexcept
+    {
+        wakeUp.signal();
+    }
+
+    /** Stop the thread, blocks until it exits. */
+    void stop()
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread(1000);
+    }
+
+private:
+    VoiceRenderPool &pool;
+    WakeSemaphore wakeUp;
+};
+
+//==============================================================================
+VoiceRenderPool::VoiceRenderPool()
+{
+    dispatch = 0;
+    remainingJobs = 0;
+}
+
+VoiceRenderPool::~VoiceRenderPool()
+{
+    setNumThreads(0);
+}
+
+//==============================================================================
+void VoiceRenderPool::setNumThreads(int numThreads)
+{
+    numThreads = jmax(0, numThreads);
+
+    while (workers.size() > numThreads)
+    {
+        workers.getLast()->stop();
+        workers.removeLast();
+    }
+
+    while (workers.size() < numThreads)
+    {
+        Worker *worker = workers.add(new Worker(*this, workers.size()));
+        worker->startThread(kWorkerPriority);
+    }
+}
+
+//==============================================================================
+void VoiceRenderPool::run(Job &job, int numJobs) noexcept
+{
+    jassert(numJobs <= 0xffff);
+
+    if (workers.size() == 0 || numJobs <= 1)
+    {
+        for (int i = 0; i < numJobs; ++i)
+            job.render(i);
+        return;
+    }
+
+    // publish the run, no worker touches currentJob until it claims a job of it
+    currentJob = &job;
+    remainingJobs.store(numJobs, std::memory_order_relaxed);
+
+    const uint32_t generation = generationOf(dispatch.load(std::memory_order_relaxed)) + 1;
+    dispatch.store(((uint64_t) generation << 32) | ((uint64_t) numJobs << 16));
+
+    // the caller takes one job, wake at most one worker for every other job
+    for (int i = jmin(workers.size(), numJobs - 1); --i >= 0;)
+        workers.getUnchecked(i)->wake();
+
+    // render whatever the workers have not claimed, then wait only for
+    // jobs they are rendering right now
+    renderJobs();
+
+    while (remainingJobs.load(std::memory_order_acquire) > 0)
+        spinPause();
+}
+
+//==============================================================================
+void VoiceRenderPool::renderJobs() noexcept
+{
+    uint64_t word = dispatch.load(std::memory_order_acquire);
+
+    while (nextJobOf(word) < numJobsOf(word))
+    {
+        if (dispatch.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            currentJob->render(nextJobOf(word));
+            remainingJobs.fetch_sub(1, std::memory_order_release);
+            word = dispatch.load(std::memory_order_acquire);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ This is Paraphrasis synthesiser.
+
+ Copyright (c) 2026 by the Paraphrasis contributors
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY, without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ */
+#ifndef VOICERENDERPOOL_H_INCLUDED
+#define VOICERENDERPOOL_H_INCLUDED
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#include <atomic>
+#include <stdint.h>
+
+using namespace juce;
+
+//==============================================================================
+/**
+ Pool of realtime priority threads rendering synthesiser voices in parallel.
+
+ run() hands out the jobs of one block through a single atomic word. The
+ calling (audio) thread renders every job no worker has claimed yet, so a
+ late worker never holds it up, and then waits only for jobs being rendered.
+ Between blocks the workers sleep on a semaphore that the audio thread
+ signals without taking a lock.
+ */
+class VoiceRenderPool
+{
+public:
+    /** Work of one run(), render() is called exactly once for every index. */
+    class Job
+    {
+    public:
+        virtual ~Job() {}
+
+        /** Render job number index. Called from any thread of the pool. */
+        virtual void render(int index) noexcept = 0;
+    };
+
+    VoiceRenderPool();
+    ~VoiceRenderPool();
+
+    /**
+     Start or stop worker threads. Not realtime safe, call it outside of the
+     audio callback.
+     @param numThreads number of workers, 0 renders everything on the calling thread.
+     */
+    void setNumThreads(int numThreads);
+
+    /** Return number of worker threads. */
+    int getNumThreads() const noexcept { return workers.size(); }
+
+    /**
+     Call job.render() for all indices from 0 to numJobs - 1 and return when
+     all of them are finished. Jobs are not ordered, the caller renders some too.
+     @param numJobs number of jobs, at most 65535.
+     */
+    void run(Job &job, int numJobs) noexcept;
+
+private:
+    class Worker;
+
+    /** Claim and render jobs of the current run until there are none left. */
+    void renderJobs() noexcept;
+
+    // dispatch word: run generation, number of jobs of the run and the next job
+    static uint32_t generationOf(uint64_t word) noexcept { return (uint32_t) (word >> 32); }
+    static int numJobsOf(uint64_t word) noexcept         { return (int) ((word >> 16) & 0xffff); }
+    static int nextJobOf(uint64_t word) noexcept         { return (int) (word & 0xffff); }
+
+    std::atomic<uint64_t> dispatch;     // current run and its next job
+    std::atomic<int> remainingJobs;     // jobs of the current run not finished yet
+    Job *currentJob = nullptr;          // written only while no job is pending
+
+    OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE(VoiceRenderPool)
+};
+
+#endif  // VOICERENDERPOOL_H_INCLUDED
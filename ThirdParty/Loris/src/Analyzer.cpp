@@ -58,9 +58,13 @@
 
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <exception>
 #include <functional>   //  for std::plus
 #include <memory>
+#include <mutex>
 #include <numeric>      //  for std::inner_product
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -295,6 +299,7 @@ Analyzer::Analyzer( const Analyzer & other ) :
     m_bwAssocParam( other.m_bwAssocParam ),
     m_sidelobeLevel( other.m_sidelobeLevel ),
     m_phaseCorrect( other.m_phaseCorrect ),
+    m_numThreads( other.m_numThreads ),
     m_partials( other.m_partials )
 {
     m_f0Builder.reset( other.m_f0Builder->clone() );
@@ -325,6 +330,7 @@ Analyzer::operator=( const Analyzer & rhs )
         m_bwAssocParam = rhs.m_bwAssocParam;
         m_sidelobeLevel = rhs.m_sidelobeLevel;
         m_phaseCorrect = rhs.m_phaseCorrect;
+        m_numThreads = rhs.m_numThreads;
         m_partials = rhs.m_partials;
 
         m_f0Builder.reset( rhs.m_f0Builder->clone() );
@@ -439,6 +445,9 @@ Analyzer::configure( double resolutionHz, double windowWidthHz )
     
     //  enable phase-correct Partial construction:
     m_phaseCorrect = true;
+
+    //  use the hardware threads, at most DefaultMaxThreads:
+    m_numThreads = 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -527,9 +536,91 @@ Analyzer::configure( const Envelope & resolutionEnv, double windowWidthHz )
     
     //  enable phase-correct Partial construction:
     m_phaseCorrect = true;
+
+    //  use the hardware threads, at most DefaultMaxThreads:
+    m_numThreads = 0;
 }
 
 // -- analysis --
+// ---------------------------------------------------------------------------
+//	Frames
+// ---------------------------------------------------------------------------
+//	Analysis window, spectrum and builders of one analysis, shared by
+//	all the blocks of samples of a streaming analysis. The window is
+//	built in double precision, the spectrum computes in the precision
+//	of the samples, T.
+//
+template < typename T >
+struct Analyzer::Frames
+{
+    double srate;
+    long winlen;                //  always odd
+    long hop;                   //  in samples, truncated
+    double oneOverSrate;        //  frame times are computed the same
+                                //  way by all threads and blocks
+    int numThreads;
+    
+    std::vector< double > window;
+    std::vector< double > windowDeriv;
+    
+    std::unique_ptr< BasicReassignedSpectrum< T > > spectrum;
+    SpectralPeakSelector selector;
+    PartialBuilder builder;
+    std::unique_ptr< AssociateBandwidth > bwAssociator;
+    
+    //  started by the first frames extracted concurrently, stopped
+    //  before the other members are destroyed
+    std::unique_ptr< PeakThreads< T > > peakThreads;
+    
+    Frames( const Analyzer & analyzer, double rate, const Envelope & reference ) :
+        srate( rate ),
+        oneOverSrate( 1. / rate ),
+        selector( rate, analyzer.m_cropTime ),
+        builder( analyzer.m_freqDrift, reference )
+    {
+        //  configure the reassigned spectral analyzer, 
+        //  always use odd-length windows:
+
+        //  Kaiser window
+        double winshape = KaiserWindow::computeShape( analyzer.sidelobeLevel() );
+        winlen = KaiserWindow::computeLength( analyzer.windowWidth() / srate, winshape );    
+        if (! (winlen % 2)) 
+        {
+            ++winlen;
+        }
+        debugger << "Using Kaiser window of length " << winlen << endl;
+        
+        window.resize( winlen );
+        KaiserWindow::buildWindow( window, winshape );
+        
+        windowDeriv.resize( winlen );
+        KaiserWindow::buildTimeDerivativeWindow( windowDeriv, winshape );
+           
+        spectrum.reset( new BasicReassignedSpectrum< T >( window, windowDeriv ) );
+        
+        //  configure bw association policy, unless
+        //  bandwidth association is disabled:
+        if( analyzer.m_bwAssocParam > 0 )
+        {
+            debugger << "Using bandwidth association regions of width " 
+                     << analyzer.bwRegionWidth() << " Hz" << endl;
+            bwAssociator.reset( new AssociateBandwidth( analyzer.bwRegionWidth(), srate ) );
+        }
+        else
+        {
+            debugger << "Bandwidth association disabled" << endl;
+        }
+        
+        hop = std::max( long( analyzer.m_hopTime * srate ), 1L );
+        numThreads = analyzer.m_numThreads;
+        if ( numThreads <= 0 )
+        {
+            numThreads = std::min( std::max( (int) std::thread::hardware_concurrency(), 1 ), 
+                                   (int) DefaultMaxThreads );
+        }
+    }
+};
+
 // ---------------------------------------------------------------------------
 //  analyze
 // ---------------------------------------------------------------------------
@@ -566,6 +657,24 @@ Analyzer::analyze( const double * bufBegin, const double * bufEnd, double srate
     analyze( bufBegin,  bufEnd, srate, reference ); 
 }
 
+// ---------------------------------------------------------------------------
+//  analyze
+// ---------------------------------------------------------------------------
+//! Analyze a range of (mono) float samples in single precision at the 
+//! given sample rate (in Hz) and store the extracted Partials in the 
+//! Analyzer's PartialList (std::list of Partials). 
+//! 
+//! \param bufBegin is a pointer to a buffer of float samples
+//! \param bufEnd is (one-past) the end of a buffer of float samples
+//! \param srate is the sample rate of the samples in the buffer
+//
+void 
+Analyzer::analyze( const float * bufBegin, const float * bufEnd, double srate )
+{ 
+    BreakpointEnvelope reference( 1.0 );
+    analyze( bufBegin,  bufEnd, srate, reference ); 
+}
+
 // ---------------------------------------------------------------------------
 //  analyze
 // ---------------------------------------------------------------------------
@@ -606,43 +715,41 @@ void
 Analyzer::analyze( const double * bufBegin, const double * bufEnd, double srate,
                    const Envelope & reference )
 { 
-    //  configure the reassigned spectral analyzer, 
-    //  always use odd-length windows:
+    analyzeSamples( bufBegin, bufEnd, srate, reference );
+}
 
-    //  Kaiser window
-    double winshape = KaiserWindow::computeShape( sidelobeLevel() );
-    long winlen = KaiserWindow::computeLength( windowWidth() / srate, winshape );    
-    if (! (winlen % 2)) 
-    {
-        ++winlen;
-    }
-    debugger << "Using Kaiser window of length " << winlen << endl;
-    
-    std::vector< double > window( winlen );
-    KaiserWindow::buildWindow( window, winshape );
-    
-    std::vector< double > windowDeriv( winlen );
-    KaiserWindow::buildTimeDerivativeWindow( windowDeriv, winshape );
-       
-    ReassignedSpectrum spectrum( window, windowDeriv );   
-    
-    //  configure the peak selection and partial formation policies:
-    SpectralPeakSelector selector( srate, m_cropTime );
-    PartialBuilder builder( m_freqDrift, reference );
-    
-    //  configure bw association policy, unless
-    //  bandwidth association is disabled:
-    std::unique_ptr< AssociateBandwidth > bwAssociator;
-    if( m_bwAssocParam > 0 )
-    {
-        debugger << "Using bandwidth association regions of width " 
-                 << bwRegionWidth() << " Hz" << endl;
-        bwAssociator.reset( new AssociateBandwidth( bwRegionWidth(), srate ) );
-    }
-    else
-    {
-        debugger << "Bandwidth association disabled" << endl;
-    }
+// ---------------------------------------------------------------------------
+//  analyze
+// ---------------------------------------------------------------------------
+//! Analyze a range of (mono) float samples in single precision at the 
+//! given sample rate (in Hz) and store the extracted Partials in the 
+//! Analyzer's PartialList (std::list of Partials). Use the specified 
+//! envelope as a frequency reference for Partial tracking.
+//! 
+//! \param bufBegin is a pointer to a buffer of float samples
+//! \param bufEnd is (one-past) the end of a buffer of float samples
+//! \param srate is the sample rate of the samples in the buffer
+//! \param reference is an Envelope having the approximate
+//! frequency contour expected of the resulting Partials.
+//
+void 
+Analyzer::analyze( const float * bufBegin, const float * bufEnd, double srate,
+                   const Envelope & reference )
+{ 
+    analyzeSamples( bufBegin, bufEnd, srate, reference );
+}
+
+// ---------------------------------------------------------------------------
+//  analyzeSamples (HELPER)
+// ---------------------------------------------------------------------------
+//  Analyze a buffer of samples of type T in the precision of T.
+//
+template < typename T >
+void 
+Analyzer::analyzeSamples( const T * bufBegin, const T * bufEnd, double srate,
+                          const Envelope & reference )
+{ 
+    Frames< T > frames( *this, srate, reference );
 
     //  reset envelope builders:
     m_ampEnvBuilder->reset();
@@ -652,67 +759,11 @@ Analyzer::analyze( const double * bufBegin, const double * bufEnd, double srate,
         
     try 
     { 
-        const double * winMiddle = bufBegin; 
-
-        //  loop over short-time analysis frames:
-        while ( winMiddle < bufEnd )
-        {
-            //  compute the time of this analysis frame:
-            const double currentFrameTime = long(winMiddle - bufBegin) / srate;
-            
-            //  compute reassigned spectrum:
-            //  sampsBegin is the position of the first sample to be transformed,
-            //  sampsEnd is the position after the last sample to be transformed.
-            //  (these computations work for odd length windows only)
-            const double * sampsBegin = std::max( winMiddle - (winlen / 2), bufBegin );
-            const double * sampsEnd = std::min( winMiddle + (winlen / 2) + 1, bufEnd );
-            spectrum.transform( sampsBegin, winMiddle, sampsEnd );
-            
-             
-            //  extract peaks from the spectrum, and thin
-            Peaks peaks = selector.selectPeaks( spectrum, m_freqFloor ); 
-			Peaks::iterator rejected = thinPeaks( peaks, currentFrameTime );
-
-            //	fix the stored bandwidth values
-            //	KLUDGE: need to do this before the bandwidth
-            //	associator tries to do its job, because the mixed
-            //	derivative is temporarily stored in the Breakpoint 
-            //	bandwidth!!! FIX!!!!
-            fixBandwidth( peaks );
-            
-            if ( m_bwAssocParam > 0 )
-            {
-                bwAssociator->associateBandwidth( peaks.begin(), rejected, peaks.end() );
-            }
-            
-            //  remove rejected Breakpoints (needed above to 
-            //  compute bandwidth envelopes):
-            peaks.erase( rejected, peaks.end() );
-            
-            //  estimate the amplitude in this frame:
-            m_ampEnvBuilder->build( peaks, currentFrameTime );
-                        
-            //  collect amplitudes and frequencies and try to 
-            //  estimate the fundamental
-            m_f0Builder->build( peaks, currentFrameTime );          
-
-            //  form Partials from the extracted Breakpoints:
-            builder.buildPartials( peaks, currentFrameTime );
-            
-            //  slide the analysis window:
-            winMiddle += long( m_hopTime * srate ); //  hop in samples, truncated
-
-        }   //  end of loop over short-time frames
-        
-        //  unwarp the Partial frequency envelopes:
-        builder.finishBuilding( m_partials );
-        
-        //  fix the frequencies and phases to be consistent.
-        if ( m_phaseCorrect )
-        {
-            fixFrequency( m_partials.begin(), m_partials.end() );
-        }
+        const long numFrames = ( long(bufEnd - bufBegin) + frames.hop - 1 ) / frames.hop;
+        analyzeFrames( frames, bufBegin, bufEnd, 0, 0, numFrames );
         
+        //  collect all the Partials:
+        collectPartials( frames, true );
         
         //  for debugging:
         /*
@@ -733,6 +784,174 @@ Analyzer::analyze( const double * bufBegin, const double * bufEnd, double srate,
     }
 }
 
+// ---------------------------------------------------------------------------
+//  analyze
+// ---------------------------------------------------------------------------
+//! Analyze (mono) samples read from a source at the given sample rate
+//! (in Hz) and store the extracted Partials in the Analyzer's
+//! PartialList (std::list of Partials).
+//!
+//! \param source provides the samples, it is read until it returns 0
+//! \param srate is the sample rate of the samples
+//
+void 
+Analyzer::analyze( SampleSource & source, double srate )
+{
+    BreakpointEnvelope reference( 1.0 );
+    analyze( source, srate, reference );
+}
+
+// ---------------------------------------------------------------------------
+//  analyze
+// ---------------------------------------------------------------------------
+//! Analyze (mono) float samples read from a source in single precision
+//! at the given sample rate (in Hz) and store the extracted Partials in
+//! the Analyzer's PartialList (std::list of Partials).
+//!
+//! \param source provides the samples, it is read until it returns 0
+//! \param srate is the sample rate of the samples
+//
+void 
+Analyzer::analyze( SampleSourceFloat & source, double srate )
+{
+    BreakpointEnvelope reference( 1.0 );
+    analyze( source, srate, reference );
+}
+
+// ---------------------------------------------------------------------------
+//  analyze
+// ---------------------------------------------------------------------------
+//! Analyze (mono) samples read from a source at the given sample rate
+//! (in Hz) and store the extracted Partials in the Analyzer's
+//! PartialList (std::list of Partials). Use the specified envelope
+//! as a frequency reference for Partial tracking.
+//!
+//! Samples are read in blocks of StreamBlockSamples, only the samples
+//! of frames not analyzed yet are kept. Partials that can not be
+//! extended any more are completed after every block, so memory does
+//! not grow with the length of the sound, only with the number of
+//! Partials. The Partials are the same as those of analyzing all the
+//! samples at once, their order in the PartialList may differ. After
+//! every block, the source is handed the Partials found so far by
+//! SampleSource::analyzed().
+//!
+//! \param source provides the samples, it is read until it returns 0
+//! \param srate is the sample rate of the samples
+//! \param reference is an Envelope having the approximate
+//! frequency contour expected of the resulting Partials.
+//
+void 
+Analyzer::analyze( SampleSource & source, double srate, const Envelope & reference )
+{
+    analyzeSource( source, srate, reference );
+}
+
+// ---------------------------------------------------------------------------
+//  analyze
+// ---------------------------------------------------------------------------
+//! Analyze (mono) float samples read from a source in single precision
+//! at the given sample rate (in Hz) and store the extracted Partials in
+//! the Analyzer's PartialList (std::list of Partials). Use the specified
+//! envelope as a frequency reference for Partial tracking. Samples are
+//! read and Partials completed like by the double precision analysis.
+//!
+//! \param source provides the samples, it is read until it returns 0
+//! \param srate is the sample rate of the samples
+//! \param reference is an Envelope having the approximate
+//! frequency contour expected of the resulting Partials.
+//
+void 
+Analyzer::analyze( SampleSourceFloat & source, double srate, const Envelope & reference )
+{
+    analyzeSource( source, srate, reference );
+}
+
+// ---------------------------------------------------------------------------
+//  analyzeSource (HELPER)
+// ---------------------------------------------------------------------------
+//  Analyze samples of type T read from a source in the precision of T.
+//
+template < typename T >
+void 
+Analyzer::analyzeSource( BasicSampleSource< T > & source, double srate, const Envelope & reference )
+{
+    Frames< T > frames( *this, srate, reference );
+
+    //  reset envelope builders:
+    m_ampEnvBuilder->reset();
+    m_f0Builder->reset();
+    
+    m_partials.clear();
+    
+    const long hop = frames.hop;
+    const long halfWindow = frames.winlen / 2;
+    
+    std::vector< T > buffer;        //  samples not needed by analyzed frames
+    long bufOffset = 0;             //  index of the first sample in buffer
+    long nextFrame = 0;             //  first frame not analyzed yet
+    bool finished = false;
+    
+    try 
+    { 
+        while ( ! finished )
+        {
+            //  read the next block:
+            const std::size_t size = buffer.size();
+            buffer.resize( size + StreamBlockSamples );
+            const long read = source.read( buffer.data() + size, StreamBlockSamples );
+            buffer.resize( size + std::max( read, 0L ) );
+            finished = ( read <= 0 );
+            
+            //  analyze the frames having all their samples, at the end
+            //  the last frames are padded with zeros like by analyze() 
+            //  of a buffer:
+            const long available = bufOffset + long( buffer.size() );
+            long endFrame = 0;
+            if ( finished )
+            {
+                endFrame = ( available + hop - 1 ) / hop;
+            }
+            else if ( available > halfWindow )
+            {
+                endFrame = ( available - halfWindow - 1 ) / hop + 1;
+            }
+            
+            if ( endFrame > nextFrame )
+            {
+                analyzeFrames( frames, buffer.data(), buffer.data() + buffer.size(), 
+                               bufOffset, nextFrame, endFrame );
+                nextFrame = endFrame;
+                
+                collectPartials( frames, finished );
+                
+                if ( ! finished )
+                {
+                    //  Breakpoints of later frames may be up to the crop 
+                    //  time earlier than the frames:
+                    source.analyzed( m_partials, frames.builder.partialsBuilding(),
+                                     ( ( endFrame - 1 ) * hop ) * frames.oneOverSrate - m_cropTime );
+                }
+            }
+            
+            //  drop the samples before the window of the next frame:
+            const long keepFrom = std::min( nextFrame * hop - halfWindow, available );
+            if ( keepFrom > bufOffset )
+            {
+                buffer.erase( buffer.begin(), buffer.begin() + ( keepFrom - bufOffset ) );
+                bufOffset = keepFrom;
+            }
+        }
+        
+        //  collect the Partials still being built:
+        collectPartials( frames, true );
+    }
+    catch ( Exception & ex ) 
+    {
+        ex.append( "analysis failed." );
+        throw;
+    }
+}
+
 // -- parameter access --
 
 // ---------------------------------------------------------------------------
@@ -859,6 +1078,18 @@ Analyzer::phaseCorrect( void ) const
     return m_phaseCorrect;
 }
 
+// ---------------------------------------------------------------------------
+//  numThreads
+// ---------------------------------------------------------------------------
+//! Return the number of threads computing spectra and peaks of
+//! analysis frames concurrently, 0 if it is the number of
+//! hardware threads, at most DefaultMaxThreads. (Default is 0.)
+int 
+Analyzer::numThreads( void ) const
+{
+    return m_numThreads;
+}
+
 // -- parameter mutation --
 
 #define VERIFY_ARG(func, test)                                          \
@@ -1030,6 +1261,24 @@ Analyzer::setPhaseCorrect( bool TF )
     m_phaseCorrect = TF;
 }
 
+// ---------------------------------------------------------------------------
+//  setNumThreads
+// ---------------------------------------------------------------------------
+//! Set the number of threads computing spectra and peaks of analysis
+//! frames concurrently. Partials are always formed from the frames
+//! in order on the calling thread, so the analyzed Partials do not
+//! depend on the number of threads.
+//!
+//! \param  n is the number of threads, 1 to analyze on the calling
+//!         thread only, 0 to use the hardware threads, at most
+//!         DefaultMaxThreads.
+void 
+Analyzer::setNumThreads( int n )
+{
+    VERIFY_ARG( setNumThreads, n >= 0 );
+    m_numThreads = n;
+}
+
 //  -- bandwidth envelope specification --
 
 
@@ -1418,4 +1667,346 @@ void Analyzer::fixBandwidth( Peaks & peaks )
 	}
 }
 
+// ---------------------------------------------------------------------------
+//	analyzeFrames (HELPER)
+// ---------------------------------------------------------------------------
+//	Analyze frames firstFrame to endFrame (exclusive) and form Partials
+//	from their peaks. Frame k is centered at sample k * hop, bufBegin is
+//	the sample bufOffset. The buffer has to hold all the samples of the
+//	frames, except before the first and after the last sample of the
+//	sound, these are zeros.
+//
+template < typename T >
+void Analyzer::analyzeFrames( Frames< T > & frames, const T * bufBegin, const T * bufEnd,
+                              long bufOffset, long firstFrame, long endFrame )
+{
+    //  form Partials from the extracted Breakpoints, frame by frame:
+    auto consume = [&]( Peaks & peaks, double currentFrameTime )
+    {
+        //  estimate the amplitude in this frame:
+        m_ampEnvBuilder->build( peaks, currentFrameTime );
+                    
+        //  collect amplitudes and frequencies and try to 
+        //  estimate the fundamental
+        m_f0Builder->build( peaks, currentFrameTime );          
+
+        //  form Partials from the extracted Breakpoints:
+        frames.builder.buildPartials( peaks, currentFrameTime );
+    };
+    
+    if ( frames.numThreads > 1 && endFrame - firstFrame > 1 )
+    {
+        extractPeaksConcurrently( frames, bufBegin, bufEnd, bufOffset, firstFrame, endFrame, consume );
+        return;
+    }
+    
+    //  loop over short-time analysis frames:
+    for ( long k = firstFrame; k < endFrame; ++k )
+    {
+        const T * winMiddle = bufBegin + ( k * frames.hop - bufOffset );
+        
+        //  compute the time of this analysis frame:
+        const double currentFrameTime = ( k * frames.hop ) * frames.oneOverSrate;
+        
+        Peaks peaks;
+        extractPeaks( *frames.spectrum, frames.selector, frames.bwAssociator.get(), 
+                      bufBegin, winMiddle, bufEnd, frames.winlen, currentFrameTime, peaks );
+        
+        consume( peaks, currentFrameTime );
+    }   //  end of loop over short-time frames
+}
+
+// ---------------------------------------------------------------------------
+//	collectPartials (HELPER)
+// ---------------------------------------------------------------------------
+//	Move Partials that can not be extended any more, or all of them,
+//	from the builder to the PartialList, fixing their frequencies and
+//	phases to be consistent.
+//
+template < typename T >
+void Analyzer::collectPartials( Frames< T > & frames, bool all )
+{
+    PartialList collected;
+    if ( all )
+    {
+        frames.builder.finishBuilding( collected );
+    }
+    else
+    {
+        frames.builder.releaseFinished( collected );
+    }
+    
+    if ( m_phaseCorrect )
+    {
+        fixFrequency( collected.begin(), collected.end() );
+    }
+    
+    m_partials.splice( m_partials.end(), collected );
+}
+
+// ---------------------------------------------------------------------------
+//	extractPeaks (HELPER)
+// ---------------------------------------------------------------------------
+//	Compute the reassigned spectrum of the frame centered at winMiddle,
+//	and collect its thinned peaks, having bandwidth associated. Only
+//	reads member variables, so frames can be processed
+//	concurrently, each thread having its own spectrum, selector and
+//	bandwidth associator (0 if bandwidth association is disabled).
+//
+template < typename T >
+void Analyzer::extractPeaks( BasicReassignedSpectrum< T > & spectrum, SpectralPeakSelector & selector,
+                             AssociateBandwidth * bwAssociator,
+                             const T * bufBegin, const T * winMiddle, const T * bufEnd,
+                             long winlen, double frameTime, Peaks & peaks )
+{
+    //  compute reassigned spectrum:
+    //  sampsBegin is the position of the first sample to be transformed,
+    //  sampsEnd is the position after the last sample to be transformed.
+    //  (these computations work for odd length windows only)
+    const T * sampsBegin = std::max( winMiddle - (winlen / 2), bufBegin );
+    const T * sampsEnd = std::min( winMiddle + (winlen / 2) + 1, bufEnd );
+    spectrum.transform( sampsBegin, winMiddle, sampsEnd );
+    
+     
+    //  extract peaks from the spectrum, and thin
+    peaks = selector.selectPeaks( spectrum, m_freqFloor ); 
+    Peaks::iterator rejected = thinPeaks( peaks, frameTime );
+
+    //	fix the stored bandwidth values
+    //	KLUDGE: need to do this before the bandwidth
+    //	associator tries to do its job, because the mixed
+    //	derivative is temporarily stored in the Breakpoint 
+    //	bandwidth!!! FIX!!!!
+    fixBandwidth( peaks );
+    
+    if ( bwAssociator != 0 )
+    {
+        bwAssociator->associateBandwidth( peaks.begin(), rejected, peaks.end() );
+    }
+    
+    //  remove rejected Breakpoints (needed above to 
+    //  compute bandwidth envelopes):
+    peaks.erase( rejected, peaks.end() );
+}
+
+// ---------------------------------------------------------------------------
+//	PeakThreads
+// ---------------------------------------------------------------------------
+//	Threads extracting peaks of the frames of one analysis. Every thread
+//	builds its own spectrum, selector and bandwidth associator once, then
+//	takes the next frame not yet taken of the current block, and waits
+//	for the next block when there is none. Extracted frames wait in a
+//	reorder queue of a few frames per thread until all frames before them
+//	are consumed, threads running ahead of the consumer wait for a free
+//	slot, so memory is bounded.
+//
+//	An exception thrown by any thread stops all of them, it is rethrown
+//	by extractPeaksConcurrently() on the calling thread.
+//
+template < typename T >
+struct Analyzer::PeakThreads
+{
+    struct Frame
+    {
+        long index;
+        double time;
+        Peaks peaks;
+        Frame( void ) : index( -1 ), time( 0 ) {}
+    };
+    
+    std::vector< Frame > queue;
+    std::mutex mutex;
+    std::condition_variable frameReady, slotFree;
+    
+    //  the block of frames being extracted:
+    const T * bufBegin;
+    const T * bufEnd;
+    long bufOffset;
+    long nextFrame;             //  next frame to be taken by a thread
+    long endFrame;
+    long consumedFrames;        //  frames handed to the consumer
+    
+    bool stopping;
+    std::exception_ptr error;
+    std::vector< std::thread > threads;
+    
+    PeakThreads( Analyzer & analyzer, const Frames< T > & frames ) :
+        queue( 4 * frames.numThreads ),
+        bufBegin( 0 ), bufEnd( 0 ), bufOffset( 0 ),
+        nextFrame( 0 ), endFrame( 0 ), consumedFrames( 0 ),
+        stopping( false )
+    {
+        threads.reserve( frames.numThreads );
+        try
+        {
+            for ( int i = 0; i < frames.numThreads; ++i )
+            {
+                threads.push_back( std::thread( [this, &analyzer, &frames] { run( analyzer, frames ); } ) );
+            }
+        }
+        catch ( ... )
+        {
+            stop();
+            throw;
+        }
+    }
+    
+    ~PeakThreads( void )
+    {
+        stop();
+    }
+    
+    //  Stop and join all threads, they finish the frames they took.
+    void stop( void )
+    {
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+        }
+        slotFree.notify_all();
+        
+        for ( std::thread & t : threads )
+        {
+            if ( t.joinable() )
+            {
+                t.join();
+            }
+        }
+    }
+    
+    //  Extract frames of all blocks until stopped.
+    void run( Analyzer & analyzer, const Frames< T > & frames )
+    {
+        const long hop = frames.hop;
+        const long queueSize = long( queue.size() );
+        
+        try
+        {
+            //  the FFT plans are shared, only the buffers are per thread:
+            BasicReassignedSpectrum< T > spectrum( frames.window, frames.windowDeriv );
+            SpectralPeakSelector selector( frames.selector );
+            std::unique_ptr< AssociateBandwidth > bwAssociator;
+            if ( analyzer.m_bwAssocParam > 0 )
+            {
+                bwAssociator.reset( new AssociateBandwidth( analyzer.bwRegionWidth(), frames.srate ) );
+            }
+            
+            std::unique_lock< std::mutex > lock( mutex );
+            for (;;)
+            {
+                slotFree.wait( lock, [&] { return stopping || error || 
+                                                  ( nextFrame < endFrame && nextFrame < consumedFrames + queueSize ); } );
+                if ( stopping || error )
+                {
+                    return;
+                }
+                const long k = nextFrame++;
+                const T * begin = bufBegin;
+                const T * end = bufEnd;
+                const long offset = bufOffset;
+                lock.unlock();
+                
+                //  the slot is free, its previous frame is consumed
+                Frame & frame = queue[ k % queueSize ];
+                const T * winMiddle = begin + ( k * hop - offset );
+                frame.time = ( k * hop ) * frames.oneOverSrate;
+                analyzer.extractPeaks( spectrum, selector, bwAssociator.get(), 
+                                       begin, winMiddle, end, frames.winlen, frame.time, frame.peaks );
+                
+                lock.lock();
+                frame.index = k;
+                frameReady.notify_all();
+            }
+        }
+        catch ( ... )
+        {
+            std::lock_guard< std::mutex > lock( mutex );
+            if ( ! error )
+            {
+                error = std::current_exception();
+            }
+            frameReady.notify_all();
+            slotFree.notify_all();
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+//	extractPeaksConcurrently (HELPER)
+// ---------------------------------------------------------------------------
+//	Extract peaks of all frames on numThreads threads, and hand them to
+//	consume in frame order on the calling thread. The threads are started
+//	by the first block of the analysis and serve all blocks after it.
+//	Each frame is computed exactly as by the serial loop, so the Partials
+//	are bit-identical.
+//
+template < typename T, typename Consumer >
+void Analyzer::extractPeaksConcurrently( Frames< T > & frames,
+                                         const T * bufBegin, const T * bufEnd,
+                                         long bufOffset, long firstFrame, long endFrame,
+                                         Consumer consume )
+{
+    if ( ! frames.peakThreads )
+    {
+        frames.peakThreads.reset( new PeakThreads< T >( *this, frames ) );
+    }
+    PeakThreads< T > & threads = *frames.peakThreads;
+    const long queueSize = long( threads.queue.size() );
+    
+    {
+        std::lock_guard< std::mutex > lock( threads.mutex );
+        for ( typename PeakThreads< T >::Frame & frame : threads.queue )
+        {
+            frame.index = -1;
+        }
+        threads.bufBegin = bufBegin;
+        threads.bufEnd = bufEnd;
+        threads.bufOffset = bufOffset;
+        threads.nextFrame = firstFrame;
+        threads.endFrame = endFrame;
+        threads.consumedFrames = firstFrame;
+    }
+    threads.slotFree.notify_all();
+    
+    try
+    {
+        for ( long k = firstFrame; k < endFrame; ++k )
+        {
+            typename PeakThreads< T >::Frame & frame = threads.queue[ k % queueSize ];
+            {
+                std::unique_lock< std::mutex > lock( threads.mutex );
+                threads.frameReady.wait( lock, [&] { return threads.error || frame.index == k; } );
+                if ( threads.error )
+                {
+                    break;
+                }
+            }
+            
+            consume( frame.peaks, frame.time );
+            
+            {
+                std::lock_guard< std::mutex > lock( threads.mutex );
+                threads.consumedFrames = k + 1;
+            }
+            threads.slotFree.notify_all();
+        }
+    }
+    catch ( ... )
+    {
+        std::lock_guard< std::mutex > lock( threads.mutex );
+        if ( ! threads.error )
+        {
+            threads.error = std::current_exception();
+        }
+    }
+    
+    //  the samples of the block may go away with the exception,
+    //  wait for the threads still reading them
+    if ( threads.error )
+    {
+        threads.stop();
+        std::rethrow_exception( threads.error );
+    }
+}
+
 }   //  end of namespace Loris
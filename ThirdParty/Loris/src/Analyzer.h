@@ -42,8 +42,11 @@
 //  begin namespace
 namespace Loris {
 
+class AssociateBandwidth;
 class Envelope;
 class LinearEnvelopeBuilder;
+template < typename T > class BasicReassignedSpectrum;
+class SpectralPeakSelector;
 // class Peaks;
 // class Peaks::iterator;
 //  oooo, this is nasty, need to fix it!
@@ -97,6 +100,13 @@ typedef std::vector< SpectralPeak > Peaks;
 //! 
 //! \sa storeResidueBandwidth, storeConvergenceBandwidth, storeNoBandwidth
 //! 
+//! Samples may be double or float. Float samples are analyzed in
+//! single precision (windows, transforms and spectra), which moves
+//! half the data and fits twice the samples in a SIMD register. The
+//! reassigned parameters are still computed in double precision, but
+//! the Partials differ slightly from those of the double precision
+//! analysis, which is the reference.
+//! 
 //! For more information about Reassigned Bandwidth-Enhanced 
 //! Analysis and the Reassigned Bandwidth-Enhanced Additive Sound 
 //! Model, refer to the Loris website: www.cerlsoundgroup.org/Loris/.
@@ -224,6 +234,78 @@ public:
     //! \param  srate is the sample rate of the samples in the buffer
     void analyze( const double * bufBegin, const double * bufEnd, double srate );
     
+    //! Analyze a range of (mono) float samples in single precision at
+    //! the given sample rate (in Hz) and store the extracted Partials
+    //! in the Analyzer's PartialList (std::list of Partials).    
+    //! 
+    //! \param  bufBegin is a pointer to a buffer of float samples
+    //! \param  bufEnd is (one-past) the end of a buffer of float samples
+    //! \param  srate is the sample rate of the samples in the buffer
+    void analyze( const float * bufBegin, const float * bufEnd, double srate );
+    
+//  -- streaming analysis --
+
+    //! BasicSampleSource is the interface of sources of (mono) samples 
+    //! of type T analyzed without holding the whole sound in memory.
+    template < typename T >
+    class BasicSampleSource
+    {
+    public:
+        virtual ~BasicSampleSource( void ) {}
+        
+        //! Read up to maxSamples next samples into buffer.
+        //!
+        //! \param  buffer receives the samples
+        //! \param  maxSamples is the size of buffer
+        //! \return the number of samples read, 0 when there are no
+        //!         more samples
+        virtual long read( T * buffer, long maxSamples ) = 0;
+        
+        //! Called after the Partials of every block but the last are
+        //! formed. Together, complete and building hold the Partials 
+        //! found so far, they are complete up to time. Later blocks
+        //! append Breakpoints after time to the Partials being built,
+        //! and add Partials starting after time. The start time and
+        //! the first Breakpoint of a Partial never change. Does nothing
+        //! by default.
+        //!
+        //! \param  complete are the Partials that ended, all the 
+        //!         Partials of the Analyzer so far
+        //! \param  building are the Partials still being built,
+        //!         their frequencies are not fixed yet
+        //! \param  time is the time up to which the Partials are
+        //!         complete, the time of the last analyzed frame less
+        //!         the crop time
+        virtual void analyzed( const PartialList & /* complete */, 
+                               const PartialList & /* building */, double /* time */ ) {}
+    };
+    
+    //! Source of double samples, analyzed in double precision.
+    typedef BasicSampleSource< double > SampleSource;
+    
+    //! Source of float samples, analyzed in single precision.
+    typedef BasicSampleSource< float > SampleSourceFloat;
+    
+    //! Number of samples requested from a SampleSource at once.
+    enum { StreamBlockSamples = 65536 };
+
+    //! Analyze (mono) samples read from a source at the given sample 
+    //! rate (in Hz) and store the extracted Partials in the Analyzer's
+    //! PartialList (std::list of Partials). Only the samples of one block
+    //! and one window are held in memory, Partials are completed
+    //! as soon as they end.
+    //! 
+    //! \param  source provides the samples
+    //! \param  srate is the sample rate of the samples
+    void analyze( SampleSource & source, double srate );
+    
+    //! Analyze (mono) float samples read from a source in single
+    //! precision, see analyze( SampleSource &, double ).
+    //! 
+    //! \param  source provides the samples
+    //! \param  srate is the sample rate of the samples
+    void analyze( SampleSourceFloat & source, double srate );
+    
 //  -- tracking analysis --
 
     //! Analyze a vector of (mono) samples at the given sample rate         
@@ -252,6 +334,39 @@ public:
     void analyze( const double * bufBegin, const double * bufEnd, double srate,
                   const Envelope & reference );
     
+    //! Analyze a range of (mono) float samples in single precision at
+    //! the given sample rate (in Hz) and store the extracted Partials
+    //! in the Analyzer's PartialList (std::list of Partials). Use the
+    //! specified envelope as a frequency reference for Partial tracking.
+    //! 
+    //! \param  bufBegin is a pointer to a buffer of float samples
+    //! \param  bufEnd is (one-past) the end of a buffer of float samples
+    //! \param  srate is the sample rate of the samples in the buffer
+    //! \param  reference is an Envelope having the approximate
+    //!         frequency contour expected of the resulting Partials.
+    void analyze( const float * bufBegin, const float * bufEnd, double srate,
+                  const Envelope & reference );
+    
+    //! Analyze (mono) samples read from a source at the given sample 
+    //! rate (in Hz) and store the extracted Partials in the Analyzer's
+    //! PartialList (std::list of Partials). Use the specified envelope
+    //! as a frequency reference for Partial tracking.
+    //! 
+    //! \param  source provides the samples
+    //! \param  srate is the sample rate of the samples
+    //! \param  reference is an Envelope having the approximate
+    //!         frequency contour expected of the resulting Partials.
+    void analyze( SampleSource & source, double srate, const Envelope & reference );
+    
+    //! Analyze (mono) float samples read from a source in single
+    //! precision, see analyze( SampleSource &, double, const Envelope & ).
+    //! 
+    //! \param  source provides the samples
+    //! \param  srate is the sample rate of the samples
+    //! \param  reference is an Envelope having the approximate
+    //!         frequency contour expected of the resulting Partials.
+    void analyze( SampleSourceFloat & source, double srate, const Envelope & reference );
+    
 //  -- parameter access --
 
     //! Return the amplitude floor (lowest detected spectral amplitude),            
@@ -303,6 +418,11 @@ public:
     //! analysis, and false otherwise. (Default is true.)
     bool phaseCorrect( void ) const;
 
+    //! Return the number of threads computing spectra and peaks of
+    //! analysis frames concurrently, 0 if it is the number of
+    //! hardware threads, at most DefaultMaxThreads. (Default is 0.)
+    int numThreads( void ) const;
+
 
 //  -- parameter mutation --
 
@@ -375,6 +495,20 @@ public:
     //! \param  TF is a flag indicating whether or not to construct
     //!         phase-corrected Partials
     void setPhaseCorrect( bool TF = true );
+
+    //! Most threads used by default, more rarely pay off and leave
+    //! less to the rest of the program.
+    enum { DefaultMaxThreads = 4 };
+    
+    //! Set the number of threads computing spectra and peaks of analysis
+    //! frames concurrently. Partials are always formed from the frames
+    //! in order on the calling thread, so the analyzed Partials do not
+    //! depend on the number of threads.
+    //!
+    //! \param  n is the number of threads, 1 to analyze on the calling
+    //!         thread only, 0 to use the hardware threads, at most
+    //!         DefaultMaxThreads.
+    void setNumThreads( int n );
     
     
 //  -- bandwidth envelope specification --
@@ -517,6 +651,13 @@ public:
 
 private:
 
+    //  analysis window, spectrum and builders of one analysis
+    //  of samples of type T
+    template < typename T > struct Frames;
+    
+    //  threads extracting peaks of the frames of one analysis
+    template < typename T > struct PeakThreads;
+
     std::unique_ptr< Envelope > m_freqResolutionEnv;    
     							//!  in Hz, minimum instantaneous frequency distance;
                                 //!  this is the core parameter, others are, by default,
@@ -557,6 +698,9 @@ private:
                                 
     bool m_phaseCorrect;        //!  flag indicating that phases/frequencies should be
                                 //!  made consistent at the end of the analysis
+
+    int m_numThreads;           //!  number of threads extracting peaks of frames,
+                                //!  0 for the hardware threads up to DefaultMaxThreads
                             
     PartialList m_partials;     //!  collect Partials here
         
@@ -612,6 +756,47 @@ private:
     //  to the stored mixed phase derivative. Otherwise, the
     //  Peak bandwidth is set to zero.
     void fixBandwidth( Peaks & peaks );
+
+    //  Compute the reassigned spectrum of the frame centered at winMiddle,
+    //  and collect its thinned peaks, having bandwidth associated. Only
+    //  reads member variables, so frames can be processed
+    //  concurrently, each thread having its own spectrum, selector and
+    //  bandwidth associator (0 if bandwidth association is disabled).
+    template < typename T >
+    void extractPeaks( BasicReassignedSpectrum< T > & spectrum, SpectralPeakSelector & selector,
+                       AssociateBandwidth * bwAssociator,
+                       const T * bufBegin, const T * winMiddle, const T * bufEnd,
+                       long winlen, double frameTime, Peaks & peaks );
+
+    //  Extract peaks of all frames on numThreads threads, and hand
+    //  them to consume in frame order on the calling thread.
+    template < typename T, typename Consumer >
+    void extractPeaksConcurrently( Frames< T > & frames,
+                                   const T * bufBegin, const T * bufEnd,
+                                   long bufOffset, long firstFrame, long endFrame,
+                                   Consumer consume );
+
+    //  Analyze frames firstFrame to endFrame (exclusive) of samples
+    //  starting at sample bufOffset, and build Partials of their peaks.
+    template < typename T >
+    void analyzeFrames( Frames< T > & frames, const T * bufBegin, const T * bufEnd,
+                        long bufOffset, long firstFrame, long endFrame );
+
+    //  Move Partials that are complete (or all, if all is true)
+    //  to the PartialList.
+    template < typename T >
+    void collectPartials( Frames< T > & frames, bool all );
+
+    //  Analyze a buffer of samples, the analyze() members of
+    //  both precisions share these.
+    template < typename T >
+    void analyzeSamples( const T * bufBegin, const T * bufEnd, double srate,
+                         const Envelope & reference );
+
+    //  Analyze samples read from a source.
+    template < typename T >
+    void analyzeSource( BasicSampleSource< T > & source, double srate,
+                        const Envelope & reference );
                     
 };  //  end of class Analyzer
 
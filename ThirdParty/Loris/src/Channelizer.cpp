@@ -373,9 +373,20 @@ Channelizer::computeStretchFactor( double f1, double fn, double n )
 //! a function of the stretch factor. 
 //
 double Channelizer::referenceFrequencyAt( double time ) const
+{
+    return referenceFrequency( _refChannelFreq->valueAt( time ) );
+}
+
+// ---------------------------------------------------------------------------
+//	referenceFrequency
+// ---------------------------------------------------------------------------
+//  Compute the reference frequency from the value of the reference 
+//  frequency envelope, see referenceFrequencyAt.
+//
+double Channelizer::referenceFrequency( double refChannelFreq ) const
 {
     const double N = _refChannelLabel;
-    double fref = _refChannelFreq->valueAt( time ) / N;
+    double fref = refChannelFreq / N;
     
     if ( 0 != _stretchFactor )
     {
@@ -413,7 +424,19 @@ double Channelizer::referenceFrequencyAt( double time ) const
 double 
 Channelizer::computeFractionalChannelNumber( double time, double frequency ) const
 {
-    double refFreq = referenceFrequencyAt( time );
+    return fractionalChannelNumber( _refChannelFreq->valueAt( time ), frequency );
+}
+
+// ---------------------------------------------------------------------------
+//	fractionalChannelNumber
+// ---------------------------------------------------------------------------
+//  Compute the (fractional) channel number from the value of the 
+//  reference frequency envelope, see computeFractionalChannelNumber.
+//
+double 
+Channelizer::fractionalChannelNumber( double refChannelFreq, double frequency ) const
+{
+    double refFreq = referenceFrequency( refChannelFreq );
     
     if ( 0 == _stretchFactor )
     {
@@ -509,6 +532,12 @@ Channelizer::channelize( Partial & partial ) const
 
 	debugger << "channelizing Partial with " << partial.numBreakpoints() << " Breakpoints" << endl;
 			
+	//	the reference envelope is evaluated at increasing Breakpoint
+	//	times, use a cursor if it is a LinearEnvelope (it usually is):
+	static const LinearEnvelope NoEnvelope;
+	const LinearEnvelope * linearRef = dynamic_cast< const LinearEnvelope * >( _refChannelFreq.get() );
+	LinearEnvelope::Cursor refAt( linearRef ? *linearRef : NoEnvelope );
+	
 	//	compute an amplitude-weighted average channel
 	//	label for each Partial:
 	//double ampsum = 0.;
@@ -535,7 +564,8 @@ Channelizer::channelize( Partial & partial ) const
             weight = pow( a, _ampWeighting );
         }
         
-        weightedlabel += weight * computeFractionalChannelNumber( t, f );
+        double refChannelFreq = linearRef ? refAt.valueAt( t ) : _refChannelFreq->valueAt( t );
+        weightedlabel += weight * fractionalChannelNumber( refChannelFreq, f );
 	}
 	
 	int label = 0;
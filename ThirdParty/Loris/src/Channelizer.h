@@ -102,6 +102,12 @@ class Channelizer
                                                 //! default is 0, amplitude weighting is a bad idea
                                                 //! for many sounds
     
+    //! Helpers taking the value of the reference frequency envelope
+    //! instead of the time, see referenceFrequencyAt and
+    //! computeFractionalChannelNumber.
+    double referenceFrequency( double refChannelFreq ) const;
+    double fractionalChannelNumber( double refChannelFreq, double frequency ) const;
+    
 //  -- public interface --
 public:
 //  -- construction --
@@ -240,7 +240,9 @@ Dilator::dilate( Partial & p ) const
 	//	new Breakpoints need to be added to the Partial at times corresponding
 	//	to all target time points that are after the first Breakpoint and
 	//	before the last, otherwise, Partials may be briefly out of tune with
-	//	each other, since our Breakpoints are non-uniformly distributed in time:
+	//	each other, since our Breakpoints are non-uniformly distributed in time;
+	//	the initial time points increase, so evaluate p sequentially:
+	Partial::Cursor pAt( p );
 	for ( idx = 0; idx < _initial.size(); ++ idx )
 	{
 		if ( _initial[idx] <= p.startTime() )
@@ -253,9 +255,7 @@ Dilator::dilate( Partial & p ) const
         }
 		else
 		{
-			newp.insert( _target[idx], 
-						 Breakpoint( p.frequencyAt(_initial[idx]), p.amplitudeAt(_initial[idx]),
-									 p.bandwidthAt(_initial[idx]), p.phaseAt(_initial[idx]) ) );
+			newp.insert( _target[idx], pAt.parametersAt( _initial[idx] ) );
 		}
 	}
 	
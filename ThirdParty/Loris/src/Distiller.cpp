@@ -177,7 +177,7 @@ static void merge( Partial::const_iterator beg,
     double rbt = (removeBegin != destPartial.end())?(removeBegin.time()):(destPartial.endTime());
     double ret = (removeEnd != destPartial.end())?(removeEnd.time()):(destPartial.endTime());
     Assert( rbt <= ret );
-	destPartial.erase( removeBegin, removeEnd );
+	removeEnd = destPartial.erase( removeBegin, removeEnd );
 
     //  how about doing the fades here instead?
     //  fade in if necessary:
@@ -187,10 +187,11 @@ static void merge( Partial::const_iterator beg,
         Assert( removeEnd.time() - fadeTime > toMerge.endTime() );
 
         //	update removeEnd so that we don't remove this 
-        //	null we are inserting:
-        destPartial.insert( 
+        //	null we are inserting (insertion invalidates it anyway):
+        removeEnd = destPartial.insert( 
             removeEnd.time() - fadeTime, 
             BreakpointUtils::makeNullBefore( removeEnd.breakpoint(), fadeTime ) );
+        ++removeEnd;
 	}
 
     if ( removeEnd != destPartial.begin() )
@@ -241,10 +242,14 @@ findContribution( Partial & pshort, const Partial & plong,
     //  need only be the gap time:
 	double clearance = gapTime; // fadeTime + gapTime;
 	
+	//	plong is evaluated at increasing times, twice per 
+	//	Breakpoint, one cursor for each of those times:
+	Partial::Cursor plongAt( plong ), plongAfter( plong );
+	
 	Partial::iterator cbeg = pshort.begin();
 	while ( cbeg != pshort.end() && 
-			( plong.amplitudeAt( cbeg.time() ) > 0 ||
-			  plong.amplitudeAt( cbeg.time() + clearance ) > 0 ) )
+			( plongAt.amplitudeAt( cbeg.time() ) > 0 ||
+			  plongAfter.amplitudeAt( cbeg.time() + clearance ) > 0 ) )
 	{
 		++cbeg;
 	}
@@ -255,8 +260,8 @@ findContribution( Partial & pshort, const Partial & plong,
 	// range of Breakpoints that fit in that
 	// gap:
 	while ( cend != pshort.end() &&
-			plong.amplitudeAt( cend.time() ) == 0 &&
-			plong.amplitudeAt( cend.time() + clearance ) == 0 )
+			plongAt.amplitudeAt( cend.time() ) == 0 &&
+			plongAfter.amplitudeAt( cend.time() + clearance ) == 0 )
 	{
 		++cend;
 	}
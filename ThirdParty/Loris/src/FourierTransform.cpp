@@ -46,6 +46,10 @@
 
 #include <cmath>
 #include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 #if defined(HAVE_M_PI) && (HAVE_M_PI)
 	const double Pi = M_PI;
@@ -122,10 +126,59 @@ namespace Loris {
 using std::complex;
 using std::vector;
 
-// --- private implementation class ---
+// --- process-wide plan cache ---
+
+//  Transform directions, the sign of the exponent of the transform
+//  (the same values as FFTW_FORWARD and FFTW_BACKWARD).
+enum { ForwardTransform = -1, InverseTransform = 1 };
+
+// ---------------------------------------------------------------------------
+//  planMutex
+// ---------------------------------------------------------------------------
+//  Guard of the plan cache. The FFTW planner (and wisdom) is not
+//  thread-safe, so plans are made only while holding this lock.
+//
+static std::mutex & planMutex( void )
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+//  number of plans made, guarded by planMutex
+static unsigned long planCount = 0;
+
+// ---------------------------------------------------------------------------
+//  cachedPlan
+// ---------------------------------------------------------------------------
+//  Return the shared plan of the specified length and direction, making 
+//  it if it is not in the cache yet. Plans are read-only once made, so 
+//  any thread can use them, and they are kept until the process exits.
+//
+template < class Plan >
+static std::shared_ptr< const Plan > cachedPlan( std::size_t N, int direction )
+{
+    typedef std::map< std::pair< std::size_t, int >, std::shared_ptr< const Plan > > Cache;
+    static Cache plans;
+    
+    std::lock_guard< std::mutex > lock( planMutex() );
+    std::shared_ptr< const Plan > & plan = plans[ std::make_pair( N, direction ) ];
+    if ( ! plan )
+    {
+        plan.reset( new Plan( N, direction ) );
+        ++planCount;
+    }
+    return plan;
+}
+
+// --- private implementation classes ---
 
 // ---------------------------------------------------------------------------
-//  FTimpl
+//  FTplan and FTimpl
+//
+// Each backend defines FTplan, everything needed to compute transforms
+// of one length and direction that can be shared by all transforms 
+// (kept in the plan cache), and FTimpl, the insulating implementation 
+// class of a FourierTransform, having its own buffers.
 //
 // Insulating implementation class to insulate clients
 // completely from everything about the interaction between
@@ -141,61 +194,143 @@ using std::vector;
 
 #if defined(HAVE_FFTW3_H) && HAVE_FFTW3_H
 
+//  FFTW version 3 interface of each precision.
+template < typename T > struct FFTW3;
+
+template <> struct FFTW3< double >
+{
+    typedef fftw_complex complex_type;
+    typedef fftw_plan plan_type;
+    
+    static complex_type * alloc( std::size_t n ) { return (complex_type *)fftw_malloc( sizeof( complex_type ) * n ); }
+    static void free( complex_type * p ) { fftw_free( p ); }
+    static plan_type plan( int n, complex_type * in, complex_type * out, int sign )
+        { return fftw_plan_dft_1d( n, in, out, sign, FFTW_MEASURE ); }
+    static void execute( plan_type p, complex_type * in, complex_type * out ) { fftw_execute_dft( p, in, out ); }
+    static void destroy( plan_type p ) { fftw_destroy_plan( p ); }
+};
+
+template <> struct FFTW3< float >
+{
+    typedef fftwf_complex complex_type;
+    typedef fftwf_plan plan_type;
+    
+    static complex_type * alloc( std::size_t n ) { return (complex_type *)fftwf_malloc( sizeof( complex_type ) * n ); }
+    static void free( complex_type * p ) { fftwf_free( p ); }
+    static plan_type plan( int n, complex_type * in, complex_type * out, int sign )
+        { return fftwf_plan_dft_1d( n, in, out, sign, FFTW_MEASURE ); }
+    static void execute( plan_type p, complex_type * in, complex_type * out ) { fftwf_execute_dft( p, in, out ); }
+    static void destroy( plan_type p ) { fftwf_destroy_plan( p ); }
+};
+
+template < typename T >
+class FTplan    //  FFTW version 3
+{
+private:
+
+    typedef FFTW3< T > Api;
+    
+    typename Api::plan_type plan;
+
+public:
+
+	// Make a measured plan. Measuring overwrites the buffers, so
+	// plan on scratch buffers. The plan is executed on the buffers
+	// of each FTimpl, allocated by fftw_malloc, so aligned alike.
+	FTplan( std::size_t N, int direction ) : plan( 0 )
+	{
+		typename Api::complex_type * in = Api::alloc( N );
+		typename Api::complex_type * out = Api::alloc( N );
+		if ( 0 != in && 0 != out )
+		{
+			plan = Api::plan( N, in, out, direction );
+		}
+		Api::free( in );
+		Api::free( out );
+		
+		//	verify:
+		if ( 0 == plan )
+		{
+			Throw( RuntimeError, "FourierTransform could not make a (fftw) plan." );
+		}
+	}
+	
+	~FTplan( void )
+	{
+		Api::destroy( plan );
+	}
+	
+	// Compute a transform, out-of-place, like the plan was made.
+	void execute( typename Api::complex_type * in, typename Api::complex_type * out ) const
+	{
+		Api::execute( plan, in, out );
+	}
+	
+private:
+
+	FTplan( const FTplan & );               //  not implemented
+	FTplan & operator= ( const FTplan & );  //  not implemented
+
+}; // end of class FTplan for FFTW version 3
+
+template < typename T >
 class FTimpl    //  FFTW version 3
 {
 private:
 
-	fftw_plan plan;
-	FourierTransform::size_type N;
-	fftw_complex * ftIn;   
-	fftw_complex * ftOut;
+    typedef FFTW3< T > Api;
+    typedef typename Api::complex_type complex_type;
+
+	std::shared_ptr< const FTplan< T > > forwardPlan;
+	std::shared_ptr< const FTplan< T > > inversePlan;
+	typename BasicFourierTransform< T >::size_type N;
+	complex_type * ftIn;   
+	complex_type * ftOut;
 
 public:
    
 	// Construct an implementation instance:
 	// allocate an input buffer, and an output buffer
-	// and make a plan.
-	FTimpl( FourierTransform::size_type sz ) : 
-	  plan( 0 ), N( sz ), ftIn( 0 ), ftOut( 0 ) 
+	// and get the forward plan.
+	FTimpl( typename BasicFourierTransform< T >::size_type sz ) : 
+	  N( sz ), ftIn( 0 ), ftOut( 0 ) 
 	{      
 		// allocate buffers:
-		ftIn = (fftw_complex *)fftw_malloc( sizeof( fftw_complex ) * N );
-		ftOut = (fftw_complex *)fftw_malloc( sizeof( fftw_complex ) * N );
+		ftIn = Api::alloc( N );
+		ftOut = Api::alloc( N );
 		if ( 0 == ftIn || 0 == ftOut )
 		{
-			fftw_free( ftIn );
-			fftw_free( ftOut );
-			throw RuntimeError( "cannot allocate Fourier transform buffers" );
+			Api::free( ftIn );
+			Api::free( ftOut );
+			Throw( RuntimeError, "cannot allocate Fourier transform buffers" );
 		}
 	  
-		//	create a plan:
-		plan = fftw_plan_dft_1d( N, ftIn, ftOut, FFTW_FORWARD, FFTW_ESTIMATE );
-
-		//	verify:
-		if ( 0 == plan )
+		//	get a plan:
+		try
 		{
-			Throw( RuntimeError, "FourierTransform could not make a (fftw) plan." );
+			forwardPlan = cachedPlan< FTplan< T > >( N, ForwardTransform );
+		}
+		catch ( ... )
+		{
+			Api::free( ftIn );
+			Api::free( ftOut );
+			throw;
 		}
 	}
    
-	// Destroy the implementation instance:
-	// dump the plan.
+	// Destroy the implementation instance,
+	// the plans stay in the cache.
 	~FTimpl( void )
 	{
-		if ( 0 != plan )
-		{
-            fftw_destroy_plan( plan );
-		}         
-		
-		fftw_free( ftIn );
-		fftw_free( ftOut );
+		Api::free( ftIn );
+		Api::free( ftOut );
 	}
 	
-	// Copy complex< double >'s from a buffer into ftIn, 
+	// Copy complex< T >'s from a buffer into ftIn, 
 	// the buffer must be as long as ftIn.
-	void loadInput( const complex< double > * bufPtr )
+	void loadInput( const complex< T > * bufPtr )
 	{
-		for ( FourierTransform::size_type k = 0; k < N; ++k )
+		for ( typename BasicFourierTransform< T >::size_type k = 0; k < N; ++k )
 		{
 			ftIn[ k ][0] = bufPtr->real();  //  real part
 			ftIn[ k ][1] = bufPtr->imag();  //  imaginary part
@@ -203,13 +338,13 @@ public:
 		}
 	}
    
-	// Copy complex< double >'s from ftOut into a buffer,
+	// Copy complex< T >'s from ftOut into a buffer,
 	// which must be as long as ftOut.
-	void copyOutput( complex< double > * bufPtr ) const
+	void copyOutput( complex< T > * bufPtr ) const
 	{
-		for ( FourierTransform::size_type k = 0; k < N; ++k )
+		for ( typename BasicFourierTransform< T >::size_type k = 0; k < N; ++k )
 		{
-			*bufPtr = complex< double >( ftOut[ k ][0], ftOut[ k ][1] );
+			*bufPtr = complex< T >( ftOut[ k ][0], ftOut[ k ][1] );
 			++bufPtr;
 		}
 	}
@@ -217,7 +352,17 @@ public:
     // Compute a forward transform.
     void forward( void )
     {
-        fftw_execute( plan );
+        forwardPlan->execute( ftIn, ftOut );
+    }
+    
+    // Compute an inverse transform.
+    void inverse( void )
+    {
+        if ( ! inversePlan )
+        {
+            inversePlan = cachedPlan< FTplan< T > >( N, InverseTransform );
+        }
+        inversePlan->execute( ftIn, ftOut );
     }
     
 }; // end of class FTimpl for FFTW version 3
@@ -234,12 +379,62 @@ static void fftw_die_Loris( const char * s )
 	exit(EXIT_FAILURE);
 }
 
-class FTimpl    //  FFTW version 2
+class FTplan    //  FFTW version 2
 {
 private:
 
 	fftw_plan plan;
-	FourierTransform::size_type N;
+
+public:
+
+	// Make a plan, FFTW version 2 plans can be
+	// executed by several threads at once.
+	FTplan( std::size_t N, int direction ) : plan( 0 )
+	{
+		plan = fftw_create_plan( N, ( ForwardTransform == direction ) ? FFTW_FORWARD : FFTW_BACKWARD,
+		                         FFTW_ESTIMATE );
+
+		//	verify:
+		if ( 0 == plan )
+		{
+			Throw( RuntimeError, "FourierTransform could not make a (fftw) plan." );
+		}
+
+        //	FFTW calls fprintf a lot, which may be a problem in
+        //	non-console-enabled applications. Catch fftw_die()
+        //	calls by routing the error message to our own Notifier
+        //	and exiting, using the function defined above.
+        //
+        //	(version 2 only)
+        fftw_die_hook = fftw_die_Loris;
+	}
+	
+	~FTplan( void )
+	{
+		fftw_destroy_plan( plan );
+	}
+	
+	// Compute a transform.
+	void execute( fftw_complex * in, fftw_complex * out ) const
+	{
+        fftw_one( plan, in, out );	
+	}
+	
+private:
+
+	FTplan( const FTplan & );               //  not implemented
+	FTplan & operator= ( const FTplan & );  //  not implemented
+
+}; // end of class FTplan for FFTW version 2
+
+template < typename T >
+class FTimpl    //  FFTW version 2, computes in double precision
+{
+private:
+
+	std::shared_ptr< const FTplan > forwardPlan;
+	std::shared_ptr< const FTplan > inversePlan;
+	typename BasicFourierTransform< T >::size_type N;
 	fftw_complex * ftIn;   
 	fftw_complex * ftOut;
    
@@ -247,9 +442,9 @@ public:
 
 	// Construct an implementation instance:
 	// allocate an input buffer, and an output buffer
-	// and make a plan.
-	FTimpl( FourierTransform::size_type sz ) : 
-	  plan( 0 ), N( sz ), ftIn( 0 ), ftOut( 0 ) 
+	// and get the forward plan.
+	FTimpl( typename BasicFourierTransform< T >::size_type sz ) : 
+	  N( sz ), ftIn( 0 ), ftOut( 0 ) 
 	{      
 		// allocate buffers:
 		ftIn = (fftw_complex *)fftw_malloc( sizeof( fftw_complex ) * N );
@@ -261,43 +456,32 @@ public:
 			Throw( RuntimeError, "cannot allocate Fourier transform buffers" );
 		}
 	  
-		//	create a plan:
-		plan = fftw_create_plan_specific( N, FFTW_FORWARD, FFTW_ESTIMATE,
-                                          ftIn, 1, ftOut, 1 );
-
-		//	verify:
-		if ( 0 == plan )
+		//	get a plan:
+		try
 		{
-			Throw( RuntimeError, "FourierTransform could not make a (fftw) plan." );
+			forwardPlan = cachedPlan< FTplan >( N, ForwardTransform );
+		}
+		catch ( ... )
+		{
+			fftw_free( ftIn );
+			fftw_free( ftOut );
+			throw;
 		}
-
-        //	FFTW calls fprintf a lot, which may be a problem in
-        //	non-console-enabled applications. Catch fftw_die()
-        //	calls by routing the error message to our own Notifier
-        //	and exiting, using the function defined above.
-        //
-        //	(version 2 only)
-        fftw_die_hook = fftw_die_Loris;
 	}
    
-	// Destroy the implementation instance:
-	// dump the plan.
+	// Destroy the implementation instance,
+	// the plans stay in the cache.
 	~FTimpl( void )
 	{
-		if ( 0 != plan )
-		{
-            fftw_destroy_plan( plan );
-		}         
-		
 		fftw_free( ftIn );
 		fftw_free( ftOut );
 	}
 	
-	// Copy complex< double >'s from a buffer into ftIn, 
+	// Copy complex< T >'s from a buffer into ftIn, 
 	// the buffer must be as long as ftIn.
-	void loadInput( const complex< double > * bufPtr )
+	void loadInput( const complex< T > * bufPtr )
 	{
-		for ( FourierTransform::size_type k = 0; k < N; ++k )
+		for ( typename BasicFourierTransform< T >::size_type k = 0; k < N; ++k )
 		{
 			c_re( ftIn[ k ] ) = bufPtr->real();
 			c_im( ftIn[ k ] ) = bufPtr->imag();
@@ -305,13 +489,13 @@ public:
 		}
 	}
    
-	// Copy complex< double >'s from ftOut into a buffer,
+	// Copy complex< T >'s from ftOut into a buffer,
 	// which must be as long as ftOut.
-	void copyOutput( complex< double > * bufPtr ) const
+	void copyOutput( complex< T > * bufPtr ) const
 	{
-		for ( FourierTransform::size_type k = 0; k < N; ++k )
+		for ( typename BasicFourierTransform< T >::size_type k = 0; k < N; ++k )
 		{
-			*bufPtr = complex< double >( c_re( ftOut[ k ] ), c_im( ftOut[ k ] ) );
+			*bufPtr = complex< T >( c_re( ftOut[ k ] ), c_im( ftOut[ k ] ) );
 			++bufPtr;
 		}
 	}
@@ -319,7 +503,17 @@ public:
     // Compute a forward transform.
     void forward( void )
     {
-        fftw_one( plan, ftIn, ftOut );	
+        forwardPlan->execute( ftIn, ftOut );
+    }
+    
+    // Compute an inverse transform.
+    void inverse( void )
+    {
+        if ( ! inversePlan )
+        {
+            inversePlan = cachedPlan< FTplan >( N, InverseTransform );
+        }
+        inversePlan->execute( ftIn, ftOut );
     }
     
 }; // end of class FTimpl for FFTW version 2
@@ -332,7 +526,7 @@ public:
 extern "C" void cdft(int, int, double *, int *, double *);
 
 //  function prototype, definition below
-static void slowDFT( double * in, double * out, int N );
+static void slowDFT( const double * in, double * out, int N, int direction );
 
 //  Uses General Purpose FFT (Fast Fourier/Cosine/Sine Transform) Package
 //  by Takuya OOURA, http://momonga.t.u-tokyo.ac.jp/~ooura/fft.html defined
@@ -340,80 +534,101 @@ static void slowDFT( double * in, double * out, int N );
 //
 //  In the event that the size is not a power of two, uses a (very) slow
 //  direct DFT computation, defined below. In this case, the workspace
-//  array is not used, and the twiddle factor array is used to store the
-//  transform result.
+//  and twiddle factor arrays are not used, and the result is stored
+//  in a separate buffer of the FTimpl.
 
-class FTimpl    //  platform-neutral stand-alone implementation
+class FTplan    //  platform-neutral stand-alone implementation
 {
 private:
 
-	double * mTxInOut;      //	input/output buffer for in-place transform                                
-	double * mTwiddle;      //	storage for twiddle factors
-	int * mWorkspace;		//	workspace storage
+	vector< double > mTwiddle;  //	storage for twiddle factors
+	vector< int > mWorkspace;   //	bit reversal table
 
-	FourierTransform::size_type N;
-    
+	std::size_t N;
+	int mDirection;
     bool mIsPO2;
    
 public:
 
-	// Construct an implementation instance:
-	// allocate buffers and workspace, and
-	// initialize the twiddle factors.
-	FTimpl( FourierTransform::size_type sz ) : 
-	  mTxInOut( 0 ), mTwiddle( 0 ), mWorkspace( 0 ), N( sz ), mIsPO2( isPO2( sz ) )
+	// Make a plan: initialize the twiddle factors
+	// and the bit reversal table, cdft() only reads
+	// them afterwards.
+	FTplan( std::size_t sz, int direction ) : 
+	  N( sz ), mDirection( direction ), mIsPO2( isPO2( sz ) )
 	{      
-        mTxInOut = new double[ 2*N ]; 	
-            //	input/output buffer for in-place transform
-            
         if ( mIsPO2 )
         {    
-            mTwiddle = new double[ N/2 ]; 		
-                //	storage for twiddle factors
-                
-            mWorkspace = new int[ 2*int( std::sqrt((double)N) + 0.5 ) ];		
-                //	workspace 
-                
-            if ( 0 == mTxInOut || 0 == mTwiddle || 0 == mWorkspace )
-            {
-                delete [] mTxInOut;
-                delete [] mTwiddle;
-                delete [] mWorkspace;
-                Throw( RuntimeError, "FourierTransform: could not initialize tranform" );
-            }
-
-            mWorkspace[0] = 0;  // first time only, triggers setup    
-                                // no need to do it now, it will happen the 
-                                // first time a transform is computed
-            // cdft_double( 2*N, -1, mTxInOut, mWorkspace, mTwiddle );
+            mTwiddle.resize( N/2 );
+            mWorkspace.resize( 2*int( std::sqrt((double)N) + 0.5 ) );
+            
+            mWorkspace[0] = 0;  // triggers setup
+            vector< double > scratch( 2*N, 0. );
+            cdft( 2*N, mDirection, &scratch[0], &mWorkspace[0], &mTwiddle[0] );
+        }
+	}
+   
+    // Return true if the result of execute() is not in place.
+    bool needsResultBuffer( void ) const
+    {
+        return ! mIsPO2;
+    }
+    
+    // Compute a transform of interleaved complex numbers, in-place
+    // if this is a power of two length DFT, otherwise into result.
+    // Return the result.
+    const double * execute( double * inout, double * result ) const
+    {        
+        if ( mIsPO2 )
+        {
+            //  the tables are initialized, cdft() does not write them
+            cdft( 2*N, mDirection, inout, 
+                  const_cast< int * >( &mWorkspace[0] ), 
+                  const_cast< double * >( &mTwiddle[0] ) );
+            return inout;
         }
         else
         {
-            mTwiddle = new double[ 2*N ]; 	
-                //	use for result in slowDFT 
-                
-            if ( 0 == mTxInOut || 0 == mTwiddle )
-            {
-                delete [] mTxInOut;
-                delete [] mTwiddle;
-                Throw( RuntimeError, "FourierTransform: could not initialize tranform" );
-            }
+            slowDFT( inout, result, N, mDirection );
+            return result;
         }
-	}
+    }
+    
+}; // end of class platform-neutral stand-alone FTplan 
+
+template < typename T >
+class FTimpl    //  platform-neutral stand-alone implementation,
+{               //  computes in double precision
+private:
+
+	std::shared_ptr< const FTplan > forwardPlan;
+	std::shared_ptr< const FTplan > inversePlan;
+
+	vector< double > mTxInOut;  //	input/output buffer for in-place transform
+	vector< double > mResult;   //	output buffer for non-PO2 transforms
+	const double * mOutput;     //	output of the last transform
+
+	typename BasicFourierTransform< T >::size_type N;
    
-	// Destroy the implementation instance:
-	~FTimpl( void )
-	{
-        delete [] mTxInOut;
-        delete [] mTwiddle;
-        delete [] mWorkspace;
+public:
+
+	// Construct an implementation instance:
+	// allocate buffers and get the forward plan.
+	FTimpl( typename BasicFourierTransform< T >::size_type sz ) : 
+	  mTxInOut( 2*sz, 0. ), mOutput( 0 ), N( sz )
+	{      
+		forwardPlan = cachedPlan< FTplan >( N, ForwardTransform );
+		if ( forwardPlan->needsResultBuffer() )
+		{
+			mResult.resize( 2*N, 0. );
+		}
+		mOutput = &mTxInOut[0];
 	}
 	
-	// Copy complex< double >'s from a buffer into ftIn, 
+	// Copy complex< T >'s from a buffer into ftIn, 
 	// the buffer must be as long as ftIn.
-	void loadInput( const complex< double > * bufPtr )
+	void loadInput( const complex< T > * bufPtr )
 	{
-		for ( FourierTransform::size_type k = 0; k < N; ++k )
+		for ( typename BasicFourierTransform< T >::size_type k = 0; k < N; ++k )
 		{
 			mTxInOut[ 2*k ] = bufPtr->real();
 			mTxInOut[ 2*k+1 ] = bufPtr->imag();
@@ -421,21 +636,14 @@ public:
 		}
 	}
    
-	//  Copy complex< double >'s from ftOut into a buffer,
-	//  which must be as long as ftOut. Result might be
-    //  stored in the twiddle factor array if this is not
-    //  power of two length DFT.
-	void copyOutput( complex< double > * bufPtr ) const
+	//  Copy complex< T >'s from the output of the last 
+	//  transform into a buffer, which must be as long 
+	//  as the transform.
+	void copyOutput( complex< T > * bufPtr ) const
 	{
-        double * result = mTxInOut;
-        if ( !mIsPO2 )
-        {
-            result = mTwiddle;
-        }
-
-		for ( FourierTransform::size_type k = 0; k < N; ++k )
+		for ( typename BasicFourierTransform< T >::size_type k = 0; k < N; ++k )
 		{
-			*bufPtr = complex< double >( result[ 2*k ], result[ 2*k+1 ] );
+			*bufPtr = complex< T >( mOutput[ 2*k ], mOutput[ 2*k+1 ] );
 			++bufPtr;
 		}
 	}
@@ -443,14 +651,17 @@ public:
     // Compute a forward transform.
     void forward( void )
     {        
-        if ( mIsPO2 )
-        {
-            cdft( 2*N, -1, mTxInOut, mWorkspace, mTwiddle );
-        }
-        else
+        mOutput = forwardPlan->execute( &mTxInOut[0], mResult.empty() ? 0 : &mResult[0] );
+    }
+    
+    // Compute an inverse transform.
+    void inverse( void )
+    {
+        if ( ! inversePlan )
         {
-            slowDFT( mTxInOut, mTwiddle, N );
+            inversePlan = cachedPlan< FTplan >( N, InverseTransform );
         }
+        mOutput = inversePlan->execute( &mTxInOut[0], mResult.empty() ? 0 : &mResult[0] );
     }
     
 }; // end of class platform-neutral stand-alone FTimpl 
@@ -469,12 +680,13 @@ public:
 //! \throw  RuntimeError if the necessary buffers cannot be 
 //!         allocated, or there is an error configuring FFTW.
 //
-FourierTransform::FourierTransform( size_type len ) :
+template < typename T >
+BasicFourierTransform< T >::BasicFourierTransform( size_type len ) :
 	_buffer( len ),
-	_impl( new FTimpl( len ) )
+	_impl( new FTimpl< T >( len ) )
 {
 	//	zero:
-	std::fill( _buffer.begin(), _buffer.end(), 0. );
+	std::fill( _buffer.begin(), _buffer.end(), T( 0 ) );
 }
 
 // ---------------------------------------------------------------------------
@@ -487,9 +699,10 @@ FourierTransform::FourierTransform( size_type len ) :
 //! \throw  RuntimeError if the necessary buffers cannot be 
 //!         allocated, or there is an error configuring FFTW.
 //
-FourierTransform::FourierTransform( const FourierTransform & rhs ) :
+template < typename T >
+BasicFourierTransform< T >::BasicFourierTransform( const BasicFourierTransform & rhs ) :
 	_buffer( rhs._buffer ),
-	_impl( new FTimpl( rhs._buffer.size() ) ) // not copied
+	_impl( new FTimpl< T >( rhs._buffer.size() ) ) // not copied
 {
 }
 
@@ -498,7 +711,8 @@ FourierTransform::FourierTransform( const FourierTransform & rhs ) :
 // ---------------------------------------------------------------------------
 //! Free the resources associated with this FourierTransform.
 //
-FourierTransform::~FourierTransform( void )
+template < typename T >
+BasicFourierTransform< T >::~BasicFourierTransform( void )
 {	
    delete _impl;
 }
@@ -514,8 +728,9 @@ FourierTransform::~FourierTransform( void )
 //! \throw  RuntimeError if the necessary buffers cannot be 
 //!         allocated, or there is an error configuring FFTW.
 //
-FourierTransform &
-FourierTransform::operator=( const FourierTransform & rhs )
+template < typename T >
+BasicFourierTransform< T > &
+BasicFourierTransform< T >::operator=( const BasicFourierTransform & rhs )
 {
    if ( this != &rhs )
    {
@@ -525,7 +740,7 @@ FourierTransform::operator=( const FourierTransform & rhs )
       // but a new one is created.
       delete _impl;
       _impl = 0;
-      _impl = new FTimpl( _buffer.size() );
+      _impl = new FTimpl< T >( _buffer.size() );
    }
    
    return *this;
@@ -537,8 +752,9 @@ FourierTransform::operator=( const FourierTransform & rhs )
 //! Return the length of the transform (in samples).
 //! 
 //! \return the length of the transform in samples.
-FourierTransform::size_type 
-FourierTransform::size( void ) const 
+template < typename T >
+typename BasicFourierTransform< T >::size_type 
+BasicFourierTransform< T >::size( void ) const 
 { 
    return _buffer.size(); 
 }
@@ -551,8 +767,9 @@ FourierTransform::size( void ) const
 //! (accessed by index or by iterator) are replaced by the 
 //! transformed samples, in-place. 
 //
+template < typename T >
 void
-FourierTransform::transform( void )
+BasicFourierTransform< T >::transform( void )
 {
     // copy data into the transform input buffer:
     _impl->loadInput( &_buffer.front() );
@@ -564,6 +781,115 @@ FourierTransform::transform( void )
     _impl->copyOutput( &_buffer.front() );
 }
 
+// ---------------------------------------------------------------------------
+//	inverseTransform
+// ---------------------------------------------------------------------------
+//! Compute the inverse Fourier transform of the samples stored in
+//! the transform buffer, in-place. The result is not scaled, it is
+//! size() times the inverse transform. The inverse plan is taken
+//! from the cache the first time this is called, so that call may
+//! block on planning.
+//
+template < typename T >
+void
+BasicFourierTransform< T >::inverseTransform( void )
+{
+    _impl->loadInput( &_buffer.front() );
+    _impl->inverse();
+    _impl->copyOutput( &_buffer.front() );
+}
+
+//  the supported precisions
+template class BasicFourierTransform< double >;
+template class BasicFourierTransform< float >;
+
+// --- FourierTransformPlans members ---
+
+// ---------------------------------------------------------------------------
+//	backend
+// ---------------------------------------------------------------------------
+//! Return the name of the FFT backend Loris was built with,
+//! "FFTW3", "FFTW2" or "Ooura".
+//
+const char * 
+FourierTransformPlans::backend( void )
+{
+#if defined(HAVE_FFTW3_H) && HAVE_FFTW3_H
+    return "FFTW3";
+#elif defined(HAVE_FFTW_H) && HAVE_FFTW_H
+    return "FFTW2";
+#else
+    return "Ooura";
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//	usesWisdom
+// ---------------------------------------------------------------------------
+//! Return true if the FFT backend uses wisdom (FFTW version 3).
+//
+bool 
+FourierTransformPlans::usesWisdom( void )
+{
+#if defined(HAVE_FFTW3_H) && HAVE_FFTW3_H
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//	loadWisdom
+// ---------------------------------------------------------------------------
+//! Load FFTW wisdom saved by saveWisdom(), so that plans measured 
+//! in an earlier session need not be measured again. Only plans
+//! made after loading benefit. Only FFTW version 3 uses wisdom.
+//
+bool 
+FourierTransformPlans::loadWisdom( const std::string & path )
+{
+#if defined(HAVE_FFTW3_H) && HAVE_FFTW3_H
+    std::lock_guard< std::mutex > lock( planMutex() );
+    bool loaded = 0 != fftw_import_wisdom_from_filename( path.c_str() );
+    loaded = ( 0 != fftwf_import_wisdom_from_filename( ( path + "f" ).c_str() ) ) || loaded;
+    return loaded;
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//	saveWisdom
+// ---------------------------------------------------------------------------
+//! Save the FFTW wisdom of all plans made so far. Only FFTW version 3 
+//! uses wisdom.
+//
+bool 
+FourierTransformPlans::saveWisdom( const std::string & path )
+{
+#if defined(HAVE_FFTW3_H) && HAVE_FFTW3_H
+    std::lock_guard< std::mutex > lock( planMutex() );
+    bool saved = 0 != fftw_export_wisdom_to_filename( path.c_str() );
+    saved = ( 0 != fftwf_export_wisdom_to_filename( ( path + "f" ).c_str() ) ) && saved;
+    return saved;
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//	numPlans
+// ---------------------------------------------------------------------------
+//! Return the number of plans in the cache.
+//
+unsigned long 
+FourierTransformPlans::numPlans( void )
+{
+    std::lock_guard< std::mutex > lock( planMutex() );
+    return planCount;
+}
 
 // --- slow non-power-of-two DFT implementation ---
 
@@ -573,11 +899,12 @@ FourierTransform::transform( void )
 //	slowDFT
 // ---------------------------------------------------------------------------
 //  Non-power-of-two DFT implementation. in and out cannot be the same,
-//  and each is 2*N long, storing interleaved complex numbers.
+//  and each is 2*N long, storing interleaved complex numbers. direction
+//  is the sign of the exponent, -1 for the forward transform.
 //  This version is only used when FFTW is unavailable.
 //
 static
-void slowDFT( double * in, double * out, int N )
+void slowDFT( const double * in, double * out, int N, int direction )
 {
 #if 1 
     // slow DFT 
@@ -590,7 +917,7 @@ void slowDFT( double * in, double * out, int N )
     // accuracy is within hundredths of a percent in my experiments.
     
     const std::complex< double > eminj2pioN = 
-        std::polar( 1.0, -2.0 * Pi / N );
+        std::polar( 1.0, direction * 2.0 * Pi / N );
               
     std::complex< double > Wn = 1;
     for ( int n = 0; n < N; ++n )
@@ -626,7 +953,7 @@ void slowDFT( double * in, double * out, int N )
         std::complex< double > Xkn = 0;
         for ( int k = 0; k < N; ++k )
         {
-            std::complex< double > Wkn = std::polar( 1.0, -2.0 * Pi * k * n / N );
+            std::complex< double > Wkn = std::polar( 1.0, direction * 2.0 * Pi * k * n / N );
             Xkn += std::complex< double >( in[ 2*k ], in[ 2*k+1 ] ) * Wkn;
         }
         
@@ -37,21 +37,22 @@
  *
  */
 #include <complex>
+#include <string>
 #include <vector>
 
 //	begin namespace
 namespace Loris {
 
 //  insulating implementation class, defined in FourierTransform.C
-class FTimpl;
+template < typename T > class FTimpl;
 
 // ---------------------------------------------------------------------------
-//	class FourierTransform
+//	class BasicFourierTransform
 //
-//! FourierTransform provides a simplified interface to the FFTW library 
+//! BasicFourierTransform provides a simplified interface to the FFTW library 
 //! (www.fftw.org). Loris uses the FFTW library to perform efficient 
 //! Fourier transforms of arbitrary length. Clients store and access 
-//! the in-place transform data as a sequence of std::complex< double >.
+//! the in-place transform data as a sequence of std::complex< T >.
 //! Samples are stored in the FourierTransform instance using subscript
 //! or iterator access, the transform is computed by the transform member,
 //! and the transformed samples replace the input samples, and are 
@@ -60,28 +61,38 @@ class FTimpl;
 //! as well. Uses the standard library complex class, which implements
 //! arithmetic operations. 
 //!
-//! Supports FFTW versions 2 and 3.
-//! Does not make use of FFTW "wisdom" to speed up transform computation.
+//! FourierTransform computes in double precision, FourierTransformFloat
+//! in single precision. With FFTW version 3 both are computed natively
+//! (linking libfftw3 and libfftw3f), the other backends compute single
+//! precision transforms in double precision.
+//!
+//! Supports FFTW versions 2 and 3. Plans are made once per transform 
+//! length, direction and precision, and shared by all instances through
+//! a process-wide, thread-safe cache (see FourierTransformPlans), so 
+//! constructing FourierTransforms of a length used before is cheap.
+//! With FFTW version 3 the plans are measured, and the "wisdom" can be
+//! saved and loaded to speed up planning in later sessions.
 //!
 //! If FFTW is unavailable, uses instead the General Purpose FFT package
 //! by Takuya OOURA, http://momonga.t.u-tokyo.ac.jp/~ooura/fft.html defined
 //! in fftsg.c for power-of-two transforms, and a very slow direct DFT
 //! implementation for non-PO2 transforms. 
 //
-class FourierTransform 
+template < typename T >
+class BasicFourierTransform 
 {
 //	-- public interface --
 public:
-   
+
     //! An unsigned integral type large enough
     //! to represent the length of any transform.
-    typedef std::vector< std::complex< double > >::size_type size_type;
-
+    typedef typename std::vector< std::complex< T > >::size_type size_type;
+    
     //! The type of a non-const iterator of (complex) transform samples.
-    typedef std::vector< std::complex< double > >::iterator iterator;
+    typedef typename std::vector< std::complex< T > >::iterator iterator;
 
     //! The type of a const iterator of (complex) transform samples.		
-    typedef std::vector< std::complex< double > >::const_iterator const_iterator;
+    typedef typename std::vector< std::complex< T > >::const_iterator const_iterator;
 
 //	--- lifecycle ---
 
@@ -91,21 +102,21 @@ public:
     //!         number of samples in the transform)
     //! \throw  RuntimeError if the necessary buffers cannot be 
     //!         allocated, or there is an error configuring FFTW.
-    FourierTransform( size_type len );
-
+    BasicFourierTransform( size_type len );
+    
     //! Initialize a new FourierTransform that is a copy of another,
     //! having the same size and the same buffer contents.
     //!
     //! \param  rhs is the instance to copy
     //! \throw  RuntimeError if the necessary buffers cannot be 
     //!         allocated, or there is an error configuring FFTW.
-    FourierTransform( const FourierTransform & rhs );
-
+    BasicFourierTransform( const BasicFourierTransform & rhs );
+    
     //! Free the resources associated with this FourierTransform.
-    ~FourierTransform( void );	
-
+    ~BasicFourierTransform( void );	
+    
 //	--- operators ---
-		
+
     //! Make this FourierTransform a copy of another, having
     //! the same size and buffer contents.
     //!
@@ -113,8 +124,7 @@ public:
     //! \return a refernce to this instance
     //! \throw  RuntimeError if the necessary buffers cannot be 
     //!         allocated, or there is an error configuring FFTW.
-    FourierTransform & operator= ( const FourierTransform & rhs );
-
+    BasicFourierTransform & operator= ( const BasicFourierTransform & rhs );
 
 //	--- access/mutation ---
 
@@ -126,9 +136,9 @@ public:
     //! \param  index is the index or rank of the complex
     //!         transform sample to access. Zero is the first
     //!         position in the buffer.
-    //! \return non-const reference to the std::complex< double >
+    //! \return non-const reference to the std::complex< T >
     //!         at the specified position in the buffer.
-    std::complex< double > & operator[] ( size_type index )
+    std::complex< T > & operator[] ( size_type index )
     { 
         return _buffer[ index ]; 
     }
@@ -141,9 +151,9 @@ public:
     //! \param  index is the index or rank of the complex
     //!         transform sample to access. Zero is the first
     //!         position in the buffer.
-    //! \return const reference to the std::complex< double >
+    //! \return const reference to the std::complex< T >
     //!         at the specified position in the buffer.
-    const std::complex< double > & operator[] ( size_type index ) const
+    const std::complex< T > & operator[] ( size_type index ) const
     { 
         return _buffer[ index ]; 
     }
@@ -157,7 +167,7 @@ public:
     { 
         return _buffer.begin(); 
     }
-	
+    
     //! Return an iterator refering to the end of the sequence of
     //! complex samples in the transform buffer.
     //!
@@ -167,7 +177,7 @@ public:
     { 
         return _buffer.end(); 
     }
-
+    
     //! Return a const iterator refering to the beginning of the sequence of
     //! complex samples in the transform buffer.
     //!
@@ -177,7 +187,7 @@ public:
     { 
         return _buffer.begin(); 
     }
-	
+    
     //! Return a const iterator refering to the end of the sequence of
     //! complex samples in the transform buffer.
     //!
@@ -187,36 +197,95 @@ public:
     { 
         return _buffer.end(); 
     }
-
+      
 //	--- operations ---
-		
+
     //! Compute the Fourier transform of the samples stored in the 
     //! transform buffer. The samples stored in the transform buffer
     //! (accessed by index or by iterator) are replaced by the 
     //! transformed samples, in-place. 
     void transform( void );
 
+    //! Compute the inverse Fourier transform of the samples stored in
+    //! the transform buffer, in-place. The result is not scaled, it is
+    //! size() times the inverse transform. The inverse plan is taken
+    //! from the cache the first time this is called, so that call may
+    //! block on planning.
+    void inverseTransform( void );
+
 //	--- inquiry ---
 
     //! Return the length of the transform (in samples).
     //! 
     //! \return the length of the transform in samples.
     size_type size( void ) const ;
-                
+    
 //	-- instance variables --
 private:
 
     //! buffer containing the complex transform input before
     //! computing the transform, and the complex transform output
     //! after computing the transform
-    std::vector< std::complex< double > > _buffer;
-
+    std::vector< std::complex< T > > _buffer;
+	
     // insulating implementation instance (defined in 
     // FourierTransform.C), conceals interface to FFTW
-    FTimpl * _impl;
+    FTimpl< T > * _impl;
+   
+};	//	end of class BasicFourierTransform
+
+//! Double precision Fourier transform, used by the analysis.
+typedef BasicFourierTransform< double > FourierTransform;
+
+//! Single precision Fourier transform.
+typedef BasicFourierTransform< float > FourierTransformFloat;
+
+// ---------------------------------------------------------------------------
+//	class FourierTransformPlans
+//
+//! FourierTransformPlans gives access to the process-wide cache of
+//! plans shared by all FourierTransforms. The plans are made when
+//! a transform of a new length, direction or precision is first 
+//! constructed (or inverted) and kept until the process exits. All 
+//! members are thread-safe.
+//
+class FourierTransformPlans
+{
+//	-- public interface --
+public:
+
+    //! Return the name of the FFT backend Loris was built with,
+    //! "FFTW3", "FFTW2" or "Ooura".
+    static const char * backend( void );
+
+    //! Return true if the FFT backend uses wisdom (FFTW version 3).
+    static bool usesWisdom( void );
 
-};	//	end of class FourierTransform
+    //! Load FFTW wisdom saved by saveWisdom(), so that plans measured 
+    //! in an earlier session need not be measured again. Only plans
+    //! made after loading benefit. Only FFTW version 3 uses wisdom.
+    //!
+    //! \param  path is the file the double precision wisdom is read
+    //!         from, the single precision wisdom is read from the same
+    //!         path with "f" appended.
+    //! \return true if wisdom of either precision was loaded, false if
+    //!         there is no wisdom at path or the backend does not use wisdom.
+    static bool loadWisdom( const std::string & path );
+
+    //! Save the FFTW wisdom of all plans made so far. Only FFTW version 3 
+    //! uses wisdom.
+    //!
+    //! \param  path is the file the double precision wisdom is written
+    //!         to, the single precision wisdom is written to the same
+    //!         path with "f" appended.
+    //! \return true if the wisdom was saved, false if it could not be 
+    //!         written or the backend does not use wisdom.
+    static bool saveWisdom( const std::string & path );
 
+    //! Return the number of plans in the cache.
+    static unsigned long numPlans( void );
+   
+};	//	end of class FourierTransformPlans
 
 }	//	end of namespace Loris
 
@@ -46,7 +46,8 @@
 //  begin namespace
 namespace Loris {
 
-class ReassignedSpectrum;
+template < typename T > class BasicReassignedSpectrum;
+typedef BasicReassignedSpectrum< double > ReassignedSpectrum;
 
 // ---------------------------------------------------------------------------
 //  class FundamentalEstimator
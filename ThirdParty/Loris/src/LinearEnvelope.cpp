@@ -38,9 +38,17 @@
 
 #include "LinearEnvelope.h"
 
+#include <algorithm>
+
 //	begin namespace
 namespace Loris {
 
+//	comparitor for finding times among the breakpoints
+static bool earlier_than( const LinearEnvelope::value_type & bp, double t )
+{
+	return bp.first < t;
+}
+
 // ---------------------------------------------------------------------------
 //	constructor
 // ---------------------------------------------------------------------------
@@ -92,7 +100,22 @@ LinearEnvelope::clone( void ) const
 void
 LinearEnvelope::insert( double time, double value )
 {
-	(*this)[time] = value;
+	//	envelopes are built in time order, appending is the common case:
+	if ( empty() || back().first < time )
+	{
+		push_back( value_type( time, value ) );
+		return;
+	}
+	
+	iterator it = std::lower_bound( begin(), end(), time, earlier_than );
+	if ( it->first == time )
+	{
+		it->second = value;
+	}
+	else
+	{
+		std::vector< value_type >::insert( it, value_type( time, value ) );
+	}
 }
 
 // ---------------------------------------------------------------------------
@@ -154,6 +177,18 @@ LinearEnvelope operator/( double num, LinearEnvelope env )
 //
 double
 LinearEnvelope::valueAt( double t ) const
+{
+	return valueAt( t, std::lower_bound( begin(), end(), t, earlier_than ) );
+}
+
+// ---------------------------------------------------------------------------
+//	valueAt (with position)
+// ---------------------------------------------------------------------------
+//	Return the value at time t, it is the position of the first
+//	breakpoint not earlier than t.
+//
+double
+LinearEnvelope::valueAt( double t, const_iterator it ) const
 {
 	//	return zero if no breakpoints have been specified:
 	if ( size() == 0 ) 
@@ -161,8 +196,6 @@ LinearEnvelope::valueAt( double t ) const
 		return 0.;
 	}
 
-	const_iterator it = lower_bound( t );
-
 	if ( it == begin() ) 
 	{
 		//	t is less than the first breakpoint, extend:
@@ -171,7 +204,6 @@ LinearEnvelope::valueAt( double t ) const
 	else if ( it == end() ) 
 	{
 		//	t is greater than the last breakpoint, extend:
-		// 	(no direct way to access the last element of a map)
 		return (--it)->second;
 	}
 	else 
@@ -188,4 +220,34 @@ LinearEnvelope::valueAt( double t ) const
 	}
 }
 
+// ---------------------------------------------------------------------------
+//	Cursor::valueAt
+// ---------------------------------------------------------------------------
+//!	Return the linearly-interpolated value of the envelope at 
+//!	the specified time, same as LinearEnvelope::valueAt.
+//!	
+//!	\param   t is the time at which to evaluate the envelope.
+//
+double
+LinearEnvelope::Cursor::valueAt( double t )
+{
+	const_iterator it = m_env->begin() + m_pos;
+	
+	if ( it != m_env->begin() && (it - 1)->first >= t )
+	{
+		//	moved back in time, search the breakpoints passed:
+		it = std::lower_bound( m_env->begin(), it, t, earlier_than );
+	}
+	else
+	{
+		while ( it != m_env->end() && it->first < t )
+		{
+			++it;
+		}
+	}
+	
+	m_pos = it - m_env->begin();
+	return m_env->valueAt( t, it );
+}
+
 }	//	end of namespace Loris
@@ -34,7 +34,8 @@
  */
 
 #include "Envelope.h"
-#include <map>
+#include <utility>
+#include <vector>
 
 //  begin namespace
 namespace Loris {
@@ -64,9 +65,13 @@ namespace Loris {
 //!     \li iterator end( void )
 //!     \li const_iterator end( void ) const
 //!
-//! from std::map< double, double >.
+//! from std::vector< std::pair< double, double > >. The breakpoints
+//! are stored contiguously, sorted by time.
+//!
+//! Envelopes evaluated at increasing times, like once per Breakpoint
+//! of a Partial, are best evaluated through a LinearEnvelope::Cursor.
 //
-class LinearEnvelope : public Envelope, private std::map< double, double >
+class LinearEnvelope : public Envelope, private std::vector< std::pair< double, double > >
 {
 //  -- public interface --
 public:
@@ -153,17 +158,55 @@ public:
         return operator*=( 1.0 / div );
     }
 
-//  -- interface inherited from std::map --
-
-    using std::map< double, double >::size;
-    using std::map< double, double >::empty;
-    using std::map< double, double >::clear;
-    using std::map< double, double >::begin;
-    using std::map< double, double >::end;
-    using std::map< double, double >::size_type;
-    using std::map< double, double >::value_type;
-    using std::map< double, double >::iterator;
-    using std::map< double, double >::const_iterator;
+//  -- interface inherited from std::vector --
+
+    using std::vector< std::pair< double, double > >::size;
+    using std::vector< std::pair< double, double > >::empty;
+    using std::vector< std::pair< double, double > >::clear;
+    using std::vector< std::pair< double, double > >::begin;
+    using std::vector< std::pair< double, double > >::end;
+    using std::vector< std::pair< double, double > >::size_type;
+    using std::vector< std::pair< double, double > >::value_type;
+    using std::vector< std::pair< double, double > >::iterator;
+    using std::vector< std::pair< double, double > >::const_iterator;
+
+//  -- sequential evaluation --
+
+    //! Class Cursor evaluates a LinearEnvelope like valueAt, but it
+    //! remembers the position of the last evaluation. Evaluating at
+    //! increasing times takes amortized constant time, the cursor
+    //! only moves forward. Evaluating at an earlier time searches
+    //! the envelope again.
+    //!
+    //! A cursor is invalidated by inserting breakpoints into its
+    //! envelope.
+    class Cursor
+    {
+    public:
+        //! Construct a cursor at the beginning of an envelope.
+        //!
+        //! \param  env is the envelope to evaluate, it must outlive 
+        //!         the cursor.
+        explicit Cursor( const LinearEnvelope & env ) :
+            m_env( &env ), m_pos( 0 ) {}
+        
+        //! Return the linearly-interpolated value of the envelope at 
+        //! the specified time, same as LinearEnvelope::valueAt.
+        //! 
+        //! \param  t is the time at which to evaluate the envelope.
+        double valueAt( double t );
+        
+    private:
+        const LinearEnvelope * m_env;
+        size_type m_pos;    //  first breakpoint not earlier than the last time
+    };
+
+//  -- implementation --
+private:
+
+    //! Return the value at time t, it is the position of the first
+    //! breakpoint not earlier than t.
+    double valueAt( double t, const_iterator it ) const;
 
 };  //  end of class LinearEnvelope
 
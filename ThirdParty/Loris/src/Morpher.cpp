@@ -206,6 +206,10 @@ Morpher::morphPartials( Partial src, Partial tgt, int assignLabel )
     Partial::const_iterator src_iter = src.begin();
     Partial::const_iterator tgt_iter = tgt.begin();
     
+    //  each Partial is evaluated at the increasing Breakpoint
+    //  times of the other one:
+    Partial::Cursor srcAt( src ), tgtAt( tgt );
+    
     // find the earliest time that a Breakpoint
     // could be added to the morph:
     double dontAddBefore = 0;
@@ -240,7 +244,7 @@ Morpher::morphPartials( Partial src, Partial tgt, int assignLabel )
             //  the end of the new Partial by more than the gap time.
             if ( dontAddBefore <= src_iter.time() )
             {
-                appendMorphedSrc( src_iter.breakpoint(), tgt, src_iter.time(), newp );
+                appendMorphedSrc( src_iter.breakpoint(), tgtAt, src_iter.time(), newp );
             }
 
             ++src_iter;
@@ -255,7 +259,7 @@ Morpher::morphPartials( Partial src, Partial tgt, int assignLabel )
             //  the end of the new Partial by more than the gap time.
             if ( dontAddBefore <= tgt_iter.time() )
             {
-                appendMorphedTgt( tgt_iter.breakpoint(), src, tgt_iter.time(), newp );
+                appendMorphedTgt( tgt_iter.breakpoint(), srcAt, tgt_iter.time(), newp );
             }
 
             ++tgt_iter;
@@ -1416,17 +1420,19 @@ Morpher::interpolateParameters( const Breakpoint & srcBkpt, const Breakpoint & t
 //!
 //! \param  srcBkpt is the Breakpoint corresponding to a morph function
 //!         value of 0.
-//! \param  tgtPartial is the Partial corresponding to a morph function
-//!         value of 1, evaluated at the specified time.
+//! \param  tgtAt evaluates the Partial corresponding to a morph function
+//!         value of 1 at the specified time.
 //! \param  time is the time corresponding to srcBkpt (used
-//!         to evaluate the morphing functions and tgtPartial).
+//!         to evaluate the morphing functions and tgtAt).
 //! \param  newp is the morphed Partial under construction, the morphed
 //!         Breakpoint is added to this Partial.
 //
 void
-Morpher::appendMorphedSrc( Breakpoint srcBkpt, const Partial & tgtPartial, 
+Morpher::appendMorphedSrc( Breakpoint srcBkpt, Partial::Cursor & tgtAt, 
                            double time, Partial & newp  )
 {
+    const Partial & tgtPartial = tgtAt.partial();
+
     double fweight = _freqFunction->valueAt( time );
     double aweight = _ampFunction->valueAt( time );
     double bweight = _bwFunction->valueAt( time );
@@ -1440,7 +1446,7 @@ Morpher::appendMorphedSrc( Breakpoint srcBkpt, const Partial & tgtPartial,
                     ( newp.last().amplitude() != 0 ) &&
                     ( srcBkpt.amplitude() == 0) &&
                     ( tgtPartial.numBreakpoints() != 0 ) &&
-                    ( tgtPartial.amplitudeAt( time ) == 0 );
+                    ( tgtAt.amplitudeAt( time ) == 0 );
 
     //  Don't insert Breakpoints at src times if all 
     //  morph functions equal 1 (or > MaxMorphParam),
@@ -1484,7 +1490,7 @@ Morpher::appendMorphedSrc( Breakpoint srcBkpt, const Partial & tgtPartial,
         }    
         else
         {
-            Breakpoint tgtBkpt = tgtPartial.parametersAt( time );
+            Breakpoint tgtBkpt = tgtAt.parametersAt( time );
             
             // adjust target Breakpoint frequencies according to the reference
             // Partial (if a reference has been specified):
@@ -1513,17 +1519,19 @@ Morpher::appendMorphedSrc( Breakpoint srcBkpt, const Partial & tgtPartial,
 //!
 //! \param  tgtBkpt is the Breakpoint corresponding to a morph function
 //!         value of 1.
-//! \param  srcPartial is the Partial corresponding to a morph function
-//!         value of 0, evaluated at the specified time.
+//! \param  srcAt evaluates the Partial corresponding to a morph function
+//!         value of 0 at the specified time.
 //! \param  time is the time corresponding to srcBkpt (used
-//!         to evaluate the morphing functions and srcPartial).
+//!         to evaluate the morphing functions and srcAt).
 //! \param  newp is the morphed Partial under construction, the morphed
 //!         Breakpoint is added to this Partial.
 //
 void
-Morpher::appendMorphedTgt( Breakpoint tgtBkpt, const Partial & srcPartial, 
+Morpher::appendMorphedTgt( Breakpoint tgtBkpt, Partial::Cursor & srcAt, 
                            double time, Partial & newp  )
-{    
+{
+    const Partial & srcPartial = srcAt.partial();
+    
     double fweight = _freqFunction->valueAt( time );
     double aweight = _ampFunction->valueAt( time );
     double bweight = _bwFunction->valueAt( time );
@@ -1537,7 +1545,7 @@ Morpher::appendMorphedTgt( Breakpoint tgtBkpt, const Partial & srcPartial,
                     ( newp.last().amplitude() != 0 ) &&
                     ( tgtBkpt.amplitude() == 0) &&
                     ( srcPartial.numBreakpoints() != 0 ) &&
-                    ( srcPartial.amplitudeAt( time ) == 0 );
+                    ( srcAt.amplitudeAt( time ) == 0 );
 
     //  Don't insert Breakpoints at src times if all 
     //  morph functions equal 0 (or < MinMorphParam),
@@ -1581,7 +1589,7 @@ Morpher::appendMorphedTgt( Breakpoint tgtBkpt, const Partial & srcPartial,
         }
         else
         {
-            Breakpoint srcBkpt = srcPartial.parametersAt( time );
+            Breakpoint srcBkpt = srcAt.parametersAt( time );
 
             // adjust source Breakpoint frequencies according to the reference
             // Partial (if a reference has been specified):
@@ -35,6 +35,7 @@
 #include "PartialList.h"
 #include "Partial.h"
 
+#include <map>
 #include <memory>   // for unique_ptr
 
 //  begin namespace
@@ -535,14 +536,14 @@ private:
     //!
     //! \param  srcBkpt is the Breakpoint corresponding to a morph function
     //!         value of 0.
-    //! \param  tgtPartial is the Partial corresponding to a morph function
-    //!         value of 1, evaluated at the specified time.
+    //! \param  tgtAt evaluates the Partial corresponding to a morph function
+    //!         value of 1 at the specified time.
     //! \param  time is the time corresponding to srcBkpt (used
-    //!         to evaluate the morphing functions and tgtPartial).
+    //!         to evaluate the morphing functions and tgtAt).
     //! \param  newp is the morphed Partial under construction, the morphed
     //!         Breakpoint is added to this Partial.
     //
-    void appendMorphedSrc( Breakpoint srcBkpt, const Partial & tgtPartial, 
+    void appendMorphedSrc( Breakpoint srcBkpt, Partial::Cursor & tgtAt, 
                            double time, Partial & newp  );
                            
     //! Compute morphed parameter values at the specified time, using
@@ -556,14 +557,14 @@ private:
     //!
     //! \param  tgtBkpt is the Breakpoint corresponding to a morph function
     //!         value of 1.
-    //! \param  srcPartial is the Partial corresponding to a morph function
-    //!         value of 0, evaluated at the specified time.
+    //! \param  srcAt evaluates the Partial corresponding to a morph function
+    //!         value of 0 at the specified time.
     //! \param  time is the time corresponding to srcBkpt (used
-    //!         to evaluate the morphing functions and srcPartial).
+    //!         to evaluate the morphing functions and srcAt).
     //! \param  newp is the morphed Partial under construction, the morphed
     //!         Breakpoint is added to this Partial.
     //
-    void appendMorphedTgt( Breakpoint tgtBkpt, const Partial & srcPartial, 
+    void appendMorphedTgt( Breakpoint tgtBkpt, Partial::Cursor & srcAt, 
                            double time, Partial & newp  );
                            
                            
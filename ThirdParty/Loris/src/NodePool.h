@@ -0,0 +1,309 @@
+#ifndef INCLUDE_NODE_POOL_H
+#define INCLUDE_NODE_POOL_H
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * NodePool.h
+ *
+ * Definition of class templates Loris::NodePool and Loris::NodePoolAllocator,
+ * a pool of equally sized memory blocks carved out of large chunks and
+ * a standard library allocator drawing single elements from it.
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+
+//	begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//	class NodePool
+//
+//!	Class NodePool hands out memory blocks of Size bytes aligned to
+//!	Align. Blocks are carved out of chunks of BlocksPerChunk blocks,
+//!	so blocks allocated one after another are adjacent in memory,
+//!	and returned blocks are kept for reuse. Every block records its
+//!	chunk, a chunk is released as soon as all of its blocks are
+//!	returned. One empty chunk is kept, so that a single short-lived
+//!	container does not allocate a chunk every time.
+//!
+//!	There is one pool per block size and alignment, shared by all
+//!	threads. A spin lock guards it, the critical sections are a few
+//!	instructions long. Chunks are allocated and released outside
+//!	of the lock.
+//
+template < std::size_t Size, std::size_t Align >
+class NodePool
+{
+//	-- public interface --
+public:
+	//!	Return the pool for blocks of this size and alignment. The pool
+	//!	is never destroyed, containers with static storage duration
+	//!	may return their blocks after the other statics are gone.
+	static NodePool & instance( void )
+	{
+		static NodePool * pool = new NodePool;
+		return *pool;
+	}
+
+	//!	Return a block of Size bytes.
+	//!
+	//!	\throw	std::bad_alloc if a new chunk can not be allocated.
+	void * allocate( void )
+	{
+		{
+			Lock lock( m_lock );
+			if ( 0 != m_available )
+			{
+				return take();
+			}
+		}
+
+		Chunk * chunk = new Chunk;
+
+		Lock lock( m_lock );
+		push( chunk );
+		return take();
+	}
+
+	//!	Return a block allocated by allocate() to the pool.
+	void deallocate( void * p ) noexcept
+	{
+		Slot * slot = reinterpret_cast< Slot * >( static_cast< unsigned char * >( p ) - offsetof( Slot, block ) );
+		Chunk * chunk = slot->chunk;
+		Chunk * release = 0;
+		{
+			Lock lock( m_lock );
+
+			slot->block.next = chunk->free;
+			chunk->free = slot;
+			if ( 0 == slot->block.next )
+			{
+				push( chunk );
+			}
+
+			if ( 0 == --chunk->used )
+			{
+				if ( 0 == m_empty )
+				{
+					m_empty = chunk;
+				}
+				else
+				{
+					unlink( chunk );
+					release = chunk;
+				}
+			}
+		}
+		delete release;
+	}
+
+//	-- implementation --
+private:
+	enum { BlocksPerChunk = 512 };
+
+	struct Chunk;
+
+	//	a block and the chunk it belongs to
+	struct Slot
+	{
+		Chunk * chunk;
+		union
+		{
+			Slot * next;
+			alignas( Align ) unsigned char storage[ Size ];
+		} block;
+	};
+
+	struct Chunk
+	{
+		Chunk * prev;           //  neighbours in the list of chunks with unused blocks
+		Chunk * next;
+		Slot * free;            //  unused blocks of this chunk
+		std::size_t used;       //  blocks handed out
+		Slot slots[ BlocksPerChunk ];
+
+		//	put the blocks on the free list in address order
+		Chunk( void ) : prev( 0 ), next( 0 ), free( 0 ), used( 0 )
+		{
+			for ( int i = BlocksPerChunk - 1; i >= 0; --i )
+			{
+				slots[ i ].chunk = this;
+				slots[ i ].block.next = free;
+				free = slots + i;
+			}
+		}
+	};
+
+	//	spin lock, yields the processor when it is held for long
+	class Lock
+	{
+	public:
+		explicit Lock( std::atomic_flag & flag ) noexcept : m_flag( flag )
+		{
+			for ( int spins = 0; m_flag.test_and_set( std::memory_order_acquire ); ++spins )
+			{
+				if ( spins >= MaxSpins )
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+		~Lock( void ) { m_flag.clear( std::memory_order_release ); }
+	private:
+		enum { MaxSpins = 64 };
+		std::atomic_flag & m_flag;
+	};
+
+	NodePool( void ) : m_available( 0 ), m_empty( 0 )
+	{
+		m_lock.clear();
+	}
+
+	//	take a block from the first chunk with unused blocks
+	void * take( void ) noexcept
+	{
+		Chunk * chunk = m_available;
+		Slot * slot = chunk->free;
+		chunk->free = slot->block.next;
+		if ( 0 == chunk->free )
+		{
+			unlink( chunk );
+		}
+		if ( chunk == m_empty )
+		{
+			m_empty = 0;
+		}
+		++chunk->used;
+		return &slot->block;
+	}
+
+	//	insert a chunk at the front of the list of chunks with unused blocks
+	void push( Chunk * chunk ) noexcept
+	{
+		chunk->prev = 0;
+		chunk->next = m_available;
+		if ( 0 != m_available )
+		{
+			m_available->prev = chunk;
+		}
+		m_available = chunk;
+	}
+
+	//	remove a chunk from the list of chunks with unused blocks
+	void unlink( Chunk * chunk ) noexcept
+	{
+		if ( 0 != chunk->prev )
+		{
+			chunk->prev->next = chunk->next;
+		}
+		else
+		{
+			m_available = chunk->next;
+		}
+		if ( 0 != chunk->next )
+		{
+			chunk->next->prev = chunk->prev;
+		}
+	}
+
+	std::atomic_flag m_lock;
+	Chunk * m_available;            //  chunks with unused blocks, the newest first
+	Chunk * m_empty;                //  the one empty chunk kept, if any
+
+	//	not implemented
+	NodePool( const NodePool & );
+	NodePool & operator=( const NodePool & );
+
+};	//	end of class NodePool
+
+// ---------------------------------------------------------------------------
+//	class NodePoolAllocator
+//
+//!	Class NodePoolAllocator is a standard library allocator taking
+//!	single elements from the NodePool for their size. Node based
+//!	containers (std::list) allocate their nodes one at a time, so
+//!	all of their nodes come from the pool. Arrays are allocated
+//!	from the free store.
+//!
+//!	The allocator has no state, all instances compare equal, so
+//!	containers using it can splice and swap freely.
+//
+template < class T >
+class NodePoolAllocator
+{
+//	-- public interface --
+public:
+	typedef T value_type;
+
+	NodePoolAllocator( void ) noexcept {}
+
+	template < class U >
+	NodePoolAllocator( const NodePoolAllocator< U > & ) noexcept {}
+
+	//!	Allocate memory for n objects of type T.
+	T * allocate( std::size_t n )
+	{
+		if ( 1 == n )
+		{
+			return static_cast< T * >( Pool::instance().allocate() );
+		}
+		return static_cast< T * >( ::operator new( n * sizeof( T ) ) );
+	}
+
+	//!	Release memory allocated by allocate( n ).
+	void deallocate( T * p, std::size_t n ) noexcept
+	{
+		if ( 1 == n )
+		{
+			Pool::instance().deallocate( p );
+		}
+		else
+		{
+			::operator delete( p );
+		}
+	}
+
+//	-- implementation --
+private:
+	typedef NodePool< sizeof( T ), alignof( T ) > Pool;
+
+};	//	end of class NodePoolAllocator
+
+template < class T, class U >
+inline bool operator==( const NodePoolAllocator< T > &, const NodePoolAllocator< U > & ) noexcept
+{
+	return true;
+}
+
+template < class T, class U >
+inline bool operator!=( const NodePoolAllocator< T > &, const NodePoolAllocator< U > & ) noexcept
+{
+	return false;
+}
+
+}	//	end of namespace Loris
+
+#endif /* ndef INCLUDE_NODE_POOL_H */
@@ -77,7 +77,13 @@ bool order_by_time( const Partial_value_type & x, const Partial_value_type & y )
 //	is easy to change the container type, but it is a much harder
 //	project to find all the places in Loris that rely on iterators
 //	that remain valid after insertions and removals.
-#undef USE_VECTOR
+//
+//	Those places were found and fixed, they use the iterators returned
+//	by insert and erase now. Partials are built by appending Breakpoints
+//	in time order, vector makes that one amortized constant time
+//	push_back instead of a tree node allocation per Breakpoint, and
+//	synthesis and resampling walk contiguous memory. Define
+//	LORIS_PARTIAL_MAP to 1 to get the map back.
 
 
 // -- construction --
@@ -204,8 +210,13 @@ Partial::end( void )
 Partial::iterator 
 Partial::erase( Partial::iterator beg, Partial::iterator end )
 {
+#if ! LORIS_PARTIAL_MAP
+	//	see note above
+	return _breakpoints.erase( beg._iter, end._iter );
+#else
 	_breakpoints.erase( beg._iter, end._iter );
 	return end;
+#endif
 }
 
 // ---------------------------------------------------------------------------
@@ -218,10 +229,10 @@ Partial::erase( Partial::iterator beg, Partial::iterator end )
 Partial::const_iterator 
 Partial::findAfter( double time ) const
 {
-#if defined(USE_VECTOR) 
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
 	Partial_value_type dummy( time, Breakpoint() );
-	return std::upper_bound( _breakpoints.begin(), _breakpoints.end(), dummy, order_by_time );
+	return std::lower_bound( _breakpoints.begin(), _breakpoints.end(), dummy, order_by_time );
 #else
 	return _breakpoints.lower_bound( time );
 #endif
@@ -234,10 +245,10 @@ Partial::findAfter( double time ) const
 Partial::iterator 
 Partial::findAfter( double time ) 
 {
-#if defined(USE_VECTOR) 
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
 	Partial_value_type dummy( time, Breakpoint() );
-	return std::upper_bound( _breakpoints.begin(), _breakpoints.end(), dummy, order_by_time );
+	return std::lower_bound( _breakpoints.begin(), _breakpoints.end(), dummy, order_by_time );
 #else
 	return _breakpoints.lower_bound( time );
 #endif
@@ -253,24 +264,40 @@ Partial::findAfter( double time )
 Partial::iterator 
 Partial::insert( double time, const Breakpoint & bp )
 {
-#if defined(USE_VECTOR) 
+    //  do not insert a Breakpoint closer than 1ns away
+    //  from the nearest existing Breakpoint:
+    static const double MinTimeDif = 1.0E-9; // 1 ns
+    
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
+	//	Partials are built in time order, appending is the common case:
+	if ( _breakpoints.empty() || ! ( MinTimeDif > time - _breakpoints.back().first ) )
+	{
+		_breakpoints.push_back( Partial_value_type( time, bp ) );
+		return --_breakpoints.end();
+	}
+	
+	//	copy, bp may refer to a Breakpoint of this Partial:
+	Partial_value_type value( time, bp );
+	
 	//	find the position at which to insert the new Breakpoint:
-	Partial_value_type dummy( time, Breakpoint() );
-	Partial::container_type::iterator insertHere = 
-		std::lower_bound( _breakpoints.begin(), _breakpoints.end(), dummy, order_by_time );
-		
-	//	if the time at insertHere is equal to the insertion time,
-	//	simply replace the Breakpoint, otherwise insert:
-	if ( insertHere->first == time )
+	container_type::iterator pos = 
+		std::lower_bound( _breakpoints.begin(), _breakpoints.end(), value, order_by_time );
+	
+	//  the time of pos is either equal to or greater
+	//  than the insertion time, if this is too close, 
+	//  remove the Breakpoint at pos, otherwise, if the 
+	//  preceding position is too close, remove that one:
+	if ( _breakpoints.end() != pos && MinTimeDif > pos->first - time )
 	{
-		insertHere->second = bp;
+		pos = _breakpoints.erase( pos );
 	}
-	else
+	else if ( _breakpoints.begin() != pos && MinTimeDif > time - (pos - 1)->first )
 	{
-		insertHere = _breakpoints.insert( insertHere, Partial_value_type(time, bp) );
+		pos = _breakpoints.erase( pos - 1 );
 	}
-	return insertHere;
+	
+	return _breakpoints.insert( pos, value );
 #else
     /*
     //  this allows Breakpoints to be inserted arbitrarily
@@ -285,10 +312,6 @@ Partial::insert( double time, const Breakpoint & bp )
 	return result.first;
     */
     
-    //  do not insert a Breakpoint closer than 1ns away
-    //  from the nearest existing Breakpoint:
-    static const double MinTimeDif = 1.0E-9; // 1 ns
-    
     //  find the insertion point for this time
     container_type::iterator pos = _breakpoints.lower_bound( time );
     
@@ -364,7 +387,7 @@ Partial::first( void )
 	{
 		Throw( InvalidPartial, "Tried find first Breakpoint in a Partial with no Breakpoints." );
 	}
-#if defined(USE_VECTOR) 
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
 	return _breakpoints.front().second;
 #else
@@ -386,7 +409,7 @@ Partial::first( void ) const
 	{
 		Throw( InvalidPartial, "Tried find first Breakpoint in a Partial with no Breakpoints." );
 	}
-#if defined(USE_VECTOR) 
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
 	return _breakpoints.front().second;
 #else
@@ -408,7 +431,7 @@ Partial::last( void )
 	{
 		Throw( InvalidPartial, "Tried find last Breakpoint in a Partial with no Breakpoints." );
 	}
-#if defined(USE_VECTOR) 
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
 	return _breakpoints.back().second;
 #else
@@ -430,7 +453,7 @@ Partial::last( void ) const
 	{
 		Throw( InvalidPartial, "Tried find last Breakpoint in a Partial with no Breakpoints." );
 	}	
-#if defined(USE_VECTOR) 
+#if ! LORIS_PARTIAL_MAP
 	//	see note above
 	return _breakpoints.back().second;
 #else
@@ -499,6 +522,7 @@ Partial::endTime( void ) const
 void 
 Partial::absorb( const Partial & other )
 {
+	Partial::Cursor otherAt( other );
 	Partial::iterator it = findAfter( other.startTime() );
 	while ( it != end() && !(it.time() > other.endTime()) )
 	{
@@ -510,7 +534,7 @@ Partial::absorb( const Partial & other )
 		{
 			// absorb energy from other at the time
 			// of this Breakpoint:
-			double a = other.amplitudeAt( it.time() );
+			double a = otherAt.amplitudeAt( it.time() );
 			it->addNoiseEnergy( a * a );
 		}	
 		++it;
@@ -757,6 +781,19 @@ static inline double wrapPi( double x )
 //
 Breakpoint
 Partial::parametersAt( double time, double fadeTime ) const 
+{
+	return parametersAt( time, fadeTime, findAfter( time ) );
+}
+
+// ---------------------------------------------------------------------------
+//	parametersAt (with position)
+// ---------------------------------------------------------------------------
+//	Return the interpolated parameters of this Partial at the specified
+//	time, pos is the position of the first Breakpoint not earlier than
+//	time (as returned by findAfter( time )).
+//
+Breakpoint
+Partial::parametersAt( double time, double fadeTime, const_iterator pos ) const 
 {
 	if ( numBreakpoints() == 0 )
 	{
@@ -824,10 +861,10 @@ Partial::parametersAt( double time, double fadeTime ) const
 	}
 	else 
 	{
-        //	findAfter returns the position of the earliest
+        //	pos is the position of the earliest
         //	Breakpoint later than time, or the end
         //	position if no such Breakpoint exists:
-        Partial::const_iterator it = findAfter( time );
+        Partial::const_iterator it = pos;
 	
         //	interpolate between it and its predeccessor
         //	(we checked already that it is not begin or end):
@@ -858,4 +895,32 @@ Partial::parametersAt( double time, double fadeTime ) const
 	return Breakpoint( freq, amp, bw, ph );
 }
 
+// ---------------------------------------------------------------------------
+//	Cursor::parametersAt
+// ---------------------------------------------------------------------------
+//!	Return the interpolated parameters of the Partial at the specified
+//!	time, same as Partial::parametersAt. Moves the cursor forward to
+//!	the time, or searches the Partial if the time is earlier than the
+//!	time of the last evaluation.
+//
+Breakpoint
+Partial::Cursor::parametersAt( double time, double fadeTime )
+{
+	Partial::const_iterator prev = _pos;
+	if ( _pos != _partial->begin() && (--prev).time() >= time )
+	{
+		//	moved back in time:
+		_pos = _partial->findAfter( time );
+	}
+	else
+	{
+		while ( _pos != _partial->end() && _pos.time() < time )
+		{
+			++_pos;
+		}
+	}
+	
+	return _partial->parametersAt( time, fadeTime, _pos );
+}
+
 }	//	end of namespace Loris
@@ -39,9 +39,20 @@
 #include "Breakpoint.h"
 #include "LorisExceptions.h"
 
-#include <map>
-//#include <utility>
-//#include <vector>
+//	Breakpoints are kept in a vector of (time, Breakpoint) pairs sorted
+//	by time, define LORIS_PARTIAL_MAP to 1 to keep them in a std::map
+//	like older versions did.
+#if !defined(LORIS_PARTIAL_MAP)
+	#define LORIS_PARTIAL_MAP 0
+#endif
+
+#include <iterator>
+#if LORIS_PARTIAL_MAP
+	#include <map>
+#else
+	#include <utility>
+	#include <vector>
+#endif
 
 //	begin namespace
 namespace Loris {
@@ -73,6 +84,12 @@ class Partial_ConstIterator;
 //!	
 //!	Partial is a leaf class, do not subclass.
 //!
+//!	Breakpoints are stored contiguously, sorted by time (unless
+//!	LORIS_PARTIAL_MAP is defined non-zero). Inserting
+//!	or erasing Breakpoints invalidates iterators and Breakpoint
+//!	references, use the iterators returned by insert() and erase().
+//!	Appending Breakpoints in time order takes constant time.
+//!
 //!	Most of the implementation of Partial delegates to a few
 //!	container-dependent members. The following members are
 //!	container-dependent, the other members are implemented in 
@@ -99,11 +116,13 @@ public:
 
 	//!	underlying Breakpoint container type, used by 
 	//!	the iterator types defined below:
+#if LORIS_PARTIAL_MAP
 	typedef std::map< double, Breakpoint > container_type;
-	
-	//	typedef std::vector< std::pair< double, Breakpoint > > container_type;
+#else
+	typedef std::vector< std::pair< double, Breakpoint > > container_type;
+#endif
 	//	see Partial.C for a discussion of issues surrounding the 
-	//	choice of std::map as a Breakpoint container.
+	//	choice of the Breakpoint container.
 
 	//! 32 bit type for labeling Partials
 	typedef int label_type;	
@@ -413,9 +432,19 @@ public:
 	//!	\throw	InvalidPartial if the Partial has no Breakpoints.
 	Breakpoint parametersAt( double time, double fadeTime = ShortestSafeFadeTime ) const;
 
+//	-- sequential parameter access --
+
+	//!	Cursor for evaluating this Partial at increasing times,
+	//!	defined below.
+	class Cursor;
+
 //	-- implementation --
 private:
 
+	//	parameters at time, pos is the position of the first
+	//	Breakpoint not earlier than time (findAfter( time ))
+	Breakpoint parametersAt( double time, double fadeTime, const_iterator pos ) const;
+
 	label_type _label;
 	container_type _breakpoints;	//	Breakpoint envelope
 	 
@@ -445,7 +474,7 @@ public:
 
 	//! The iterator category, for copmpatibility with 
 	//! C++ standard library algorithms 
-	typedef BaseIterator::iterator_category	iterator_category;
+	typedef std::bidirectional_iterator_tag	iterator_category;
 	
 	//! The type of element that can be accessed through this 
 	//! iterator (Breakpoint).
@@ -621,7 +650,7 @@ public:
 
 	//! The iterator category, for copmpatibility with 
 	//! C++ standard library algorithms 
-	typedef BaseIterator::iterator_category	iterator_category;
+	typedef std::bidirectional_iterator_tag	iterator_category;
 	
 	//! The type of element that can be accessed through this 
 	//! iterator (Breakpoint).
@@ -757,6 +786,66 @@ private:
 
 };	//	end of class Partial_ConstIterator
 
+// ---------------------------------------------------------------------------
+//	class Partial::Cursor
+//
+//!	Class Partial::Cursor evaluates a Partial like parametersAt and
+//!	the other parameter accessors of Partial, but it remembers the
+//!	position of the last evaluation. Evaluating at increasing times,
+//!	like at the times of the Breakpoints of another Partial, takes 
+//!	amortized constant time instead of a search per evaluation. 
+//!	Evaluating at an earlier time searches the Partial again.
+//!
+//!	A cursor is invalidated by inserting Breakpoints into or erasing
+//!	them from its Partial.
+//
+class Partial::Cursor
+{
+//	-- public interface --
+public:
+	//!	Construct a cursor at the beginning of a Partial.
+	//!
+	//!	\param	partial is the Partial to evaluate, it must outlive
+	//!			the cursor.
+	explicit Cursor( const Partial & partial ) :
+		_partial( &partial ), _pos( partial.begin() ) {}
+
+	//!	Return the Partial evaluated by this cursor.
+	const Partial & partial( void ) const { return *_partial; }
+
+	//!	Return the interpolated parameters of the Partial at
+	//!	the specified time, same as Partial::parametersAt.
+	//!
+	//!		hrow	InvalidPartial if the Partial has no Breakpoints.
+	Breakpoint parametersAt( double time, double fadeTime = ShortestSafeFadeTime );
+
+	//!	Return the interpolated frequency of the Partial at
+	//!	the specified time, same as Partial::frequencyAt.
+	double frequencyAt( double time ) 
+		{ return parametersAt( time ).frequency(); }
+
+	//!	Return the interpolated amplitude of the Partial at
+	//!	the specified time, same as Partial::amplitudeAt.
+	double amplitudeAt( double time, double fadeTime = ShortestSafeFadeTime ) 
+		{ return parametersAt( time, fadeTime ).amplitude(); }
+
+	//!	Return the interpolated bandwidth of the Partial at
+	//!	the specified time, same as Partial::bandwidthAt.
+	double bandwidthAt( double time ) 
+		{ return parametersAt( time ).bandwidth(); }
+
+	//!	Return the interpolated phase of the Partial at
+	//!	the specified time, same as Partial::phaseAt.
+	double phaseAt( double time ) 
+		{ return parametersAt( time ).phase(); }
+
+//	-- implementation --
+private:
+	const Partial * _partial;
+	const_iterator _pos;	//	first Breakpoint not earlier than the last time
+
+};	//	end of class Partial::Cursor
+
 // ---------------------------------------------------------------------------
 //	class InvalidPartial
 //
@@ -276,9 +276,8 @@ PartialBuilder::buildPartials( Peaks & peaks, double frameTime )
         }
         else
         {
-            Partial p;
-            p.insert( peakTime, bp );
-            mCollectedPartials.push_back( p );
+            mCollectedPartials.push_back( Partial() );
+            mCollectedPartials.back().insert( peakTime, bp );
             mNewlyEligible.push_back( & mCollectedPartials.back() );
         }
         
@@ -316,5 +315,33 @@ PartialBuilder::finishBuilding( PartialList & product )
 }
 
 
+// ---------------------------------------------------------------------------
+//	releaseFinished
+// ---------------------------------------------------------------------------
+//  Return the Partials that can not be extended any more, because
+//  they were not eligible for the peaks of the last frame, by
+//  appending them to the supplied PartialList. Partials still being
+//  built stay in the builder. Used by streaming analysis, so that
+//  the builder holds only the Partials of the current frame.
+//
+void
+PartialBuilder::releaseFinished( PartialList & product )
+{
+    //  splicing does not move the Partials, eligible pointers stay valid
+    PartialPtrs eligible( mEligiblePartials );
+    std::sort( eligible.begin(), eligible.end() );
+    
+    PartialList::iterator it = mCollectedPartials.begin();
+    while ( it != mCollectedPartials.end() )
+    {
+        PartialList::iterator next = it;
+        ++next;
+        if ( ! std::binary_search( eligible.begin(), eligible.end(), &*it ) )
+        {
+            product.splice( product.end(), mCollectedPartials, it );
+        }
+        it = next;
+    }
+}
 
 }	//	end of namespace Loris
@@ -104,6 +104,21 @@ public:
     //  supplied PartialList.
 	void finishBuilding( PartialList & product );
 
+    //  releaseFinished
+    //
+    //  Return the Partials that can not be extended any more, because
+    //  they were not eligible for the peaks of the last frame, by
+    //  appending them to the supplied PartialList. Partials still being
+    //  built stay in the builder. Used by streaming analysis, so that
+    //  the builder holds only the Partials of the current frame.
+	void releaseFinished( PartialList & product );
+
+    //  partialsBuilding
+    //
+    //  Return the Partials still being built. After releaseFinished,
+    //  these are the Partials that may be extended by the next frame.
+	const PartialList & partialsBuilding( void ) const { return mCollectedPartials; }
+
 private:
 
 // --- auxiliary member functions ---
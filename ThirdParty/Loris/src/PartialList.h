@@ -38,6 +38,7 @@
 //	without it, I can't instantiate a PartialList. I need
 //	a definition of Partial for PartialList to be unambiguous.
 #include "Partial.h"
+#include "NodePool.h"
 #include <list>
 
 //	begin namespace
@@ -52,9 +53,14 @@ namespace Loris {
 //	simply typedefs, they classes have identical interfaces to std::list,
 //	std::list::iterator, and std::list::const_iterator, respectively.
 //
-typedef std::list< Loris::Partial > PartialList;
-typedef std::list< Loris::Partial >::iterator PartialListIterator;
-typedef std::list< Loris::Partial >::const_iterator PartialListConstIterator;
+//	The list nodes are allocated from a NodePool, they are not allocated
+//	and freed one by one, and Partials built one after another are
+//	adjacent in memory, so passes over the list do not jump around the
+//	heap. References to Partials stay valid like in any std::list.
+//
+typedef std::list< Loris::Partial, Loris::NodePoolAllocator< Loris::Partial > > PartialList;
+typedef PartialList::iterator PartialListIterator;
+typedef PartialList::const_iterator PartialListConstIterator;
 
 }	//	end of namespace Loris
 
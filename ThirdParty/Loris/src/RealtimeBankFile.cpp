@@ -0,0 +1,414 @@
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimeBankFile.C
+ *
+ * Implementation of class Loris::RealtimeBankFile, binary files holding
+ * compiled RealtimePartialBanks.
+ *
+ */
+#if HAVE_CONFIG_H
+    #include "config.h"
+#endif
+#include "RealtimeBankFile.h"
+#include "LorisExceptions.h"
+#include "Resampler.h"
+#include "SdifFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//  begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//  file layout
+// ---------------------------------------------------------------------------
+static const char Magic[8] = { 'L', 'O', 'R', 'I', 'S', 'R', 'T', 'B' };
+static const uint32_t FormatVersion = 2;
+static const std::size_t CacheLine = 64;
+
+//  Breakpoint arrays in file order, all of them 4 bytes per Breakpoint
+enum { SampleArray = 0, FrequencyArray, AmplitudeArray, BandwidthArray, PhaseArray,
+       FrequencyIncrementArray, AmplitudeIncrementArray, BandwidthIncrementArray, NumBreakpointArrays };
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint32_t partialBytes;
+    int32_t numPartials;
+    int32_t numBreakpoints;
+    int32_t maxActivePartials;
+    double fadeTime;
+    double sampleRate;
+    uint64_t fileBytes;
+    float noiseEnergy;
+    uint32_t reserved;
+};
+
+static_assert( sizeof( FileHeader ) == CacheLine, "bank file header has to fill one cache line" );
+static_assert( sizeof( int ) == 4 && sizeof( float ) == 4, "bank file arrays have 4 byte elements" );
+
+//  byte offsets of the arrays of a bank
+struct Layout
+{
+    std::size_t partials;
+    std::size_t startOrder;
+    std::size_t loudnessOrder;
+    std::size_t breakpoints[NumBreakpointArrays];
+    std::size_t fileBytes;
+
+    Layout( std::size_t numPartials, std::size_t numBreakpoints )
+    {
+        std::size_t offset = sizeof( FileHeader );
+        partials = offset;
+        offset = alignUp( offset + numPartials * sizeof( PartialStruct ) );
+        startOrder = offset;
+        offset = alignUp( offset + numPartials * sizeof( int32_t ) );
+        loudnessOrder = offset;
+        offset = alignUp( offset + numPartials * sizeof( int32_t ) );
+        for (int i = 0; i < NumBreakpointArrays; ++i)
+        {
+            breakpoints[i] = offset;
+            offset = alignUp( offset + numBreakpoints * 4 );
+        }
+        fileBytes = offset;
+    }
+
+    static std::size_t alignUp( std::size_t n ) { return ( n + CacheLine - 1 ) & ~( CacheLine - 1 ); }
+};
+
+// ---------------------------------------------------------------------------
+//	littleEndianSystem
+// ---------------------------------------------------------------------------
+//	Bank files are used in place, they can only be read and written by
+//	little-endian systems.
+//
+static bool littleEndianSystem( void )
+{
+    const uint32_t one = 1;
+    char firstByte;
+    std::memcpy( &firstByte, &one, 1 );
+    return firstByte == 1;
+}
+
+// ---------------------------------------------------------------------------
+//	isFinite
+// ---------------------------------------------------------------------------
+//	Test the exponent bits, std::isfinite() may be assumed true when the
+//	library is built with -ffast-math.
+//
+static bool isFinite( double x )
+{
+    uint64_t bits;
+    std::memcpy( &bits, &x, sizeof( bits ) );
+    return ( bits & 0x7ff0000000000000ULL ) != 0x7ff0000000000000ULL;
+}
+
+// ---------------------------------------------------------------------------
+//	class FileMapping
+// ---------------------------------------------------------------------------
+//	Read-only mapping of a whole file, unmapped by the destructor.
+//
+class FileMapping
+{
+public:
+    explicit FileMapping( const std::string & filename ) :
+        m_data( 0 ),
+        m_size( 0 )
+    {
+#if defined(_WIN32)
+        m_file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+        m_mapping = NULL;
+        LARGE_INTEGER size;
+        if ( m_file == INVALID_HANDLE_VALUE || ! GetFileSizeEx( m_file, &size ) )
+        {
+            close();
+            Throw( FileIOException, "Could not open bank file " + filename );
+        }
+        m_size = (std::size_t) size.QuadPart;
+        if ( m_size > 0 )
+        {
+            m_mapping = CreateFileMappingA( m_file, NULL, PAGE_READONLY, 0, 0, NULL );
+            m_data = m_mapping ? (const char *) MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) : 0;
+        }
+#else
+        int fd = ::open( filename.c_str(), O_RDONLY );
+        struct stat st;
+        if ( fd < 0 || ::fstat( fd, &st ) != 0 )
+        {
+            if ( fd >= 0 )
+                ::close( fd );
+            Throw( FileIOException, "Could not open bank file " + filename );
+        }
+        m_size = (std::size_t) st.st_size;
+        if ( m_size > 0 )
+        {
+            void * data = ::mmap( 0, m_size, PROT_READ, MAP_SHARED, fd, 0 );
+            m_data = ( data == MAP_FAILED ) ? 0 : (const char *) data;
+        }
+        //  the mapping stays valid without the descriptor
+        ::close( fd );
+#endif
+        if ( m_data == 0 )
+        {
+            close();
+            Throw( FileIOException, "Could not map bank file " + filename );
+        }
+    }
+
+    ~FileMapping( void ) { close(); }
+
+    const char * data( void ) const { return m_data; }
+    std::size_t size( void ) const { return m_size; }
+
+private:
+    void close( void )
+    {
+#if defined(_WIN32)
+        if ( m_data )
+            UnmapViewOfFile( m_data );
+        if ( m_mapping )
+            CloseHandle( m_mapping );
+        if ( m_file != INVALID_HANDLE_VALUE )
+            CloseHandle( m_file );
+        m_mapping = NULL;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if ( m_data )
+            ::munmap( (void *) m_data, m_size );
+#endif
+        m_data = 0;
+    }
+
+    const char * m_data;
+    std::size_t m_size;
+#if defined(_WIN32)
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+
+    //  not copyable
+    FileMapping( const FileMapping & );
+    FileMapping & operator= ( const FileMapping & );
+};
+
+// ---------------------------------------------------------------------------
+//	map
+// ---------------------------------------------------------------------------
+//!	Map a bank file into memory. The returned bank uses the mapped
+//!	arrays in place, the file stays mapped until the bank is destroyed.
+//!
+//!	\param	filename The name of the bank file.
+//!	\return The mapped bank.
+//!	\throw	FileIOException if the file can not be mapped or it is not
+//!			a valid bank file of this format version.
+//
+RealtimePartialBank::Ptr
+RealtimeBankFile::map( const std::string & filename )
+{
+    if ( ! littleEndianSystem() )
+        Throw( FileIOException, "Bank files can only be used on little-endian systems." );
+
+    std::shared_ptr< FileMapping > mapping( new FileMapping( filename ) );
+    const char * data = mapping->data();
+
+    FileHeader header;
+    if ( mapping->size() < sizeof( FileHeader ) )
+        Throw( FileIOException, "Not a bank file: " + filename );
+    std::memcpy( &header, data, sizeof( FileHeader ) );
+
+    if ( std::memcmp( header.magic, Magic, sizeof( Magic ) ) != 0 ||
+         header.headerBytes != sizeof( FileHeader ) )
+        Throw( FileIOException, "Not a bank file: " + filename );
+
+    if ( header.version != FormatVersion || header.partialBytes != sizeof( PartialStruct ) )
+        Throw( FileIOException, "Unsupported bank file version: " + filename );
+
+    if ( header.numPartials < 0 || header.numBreakpoints < 0 )
+        Throw( FileIOException, "Bank file is damaged: " + filename );
+
+    //  the synthesizer reserves its Partial state and divides by the
+    //  sample rate, the bank does not check them
+    if ( header.maxActivePartials < 0 || header.maxActivePartials > header.numPartials ||
+         ! isFinite( header.sampleRate ) || header.sampleRate <= 0 ||
+         ! isFinite( header.fadeTime ) || header.fadeTime < 0 )
+        Throw( FileIOException, "Bank file is damaged: " + filename );
+
+    const std::size_t numPartials = header.numPartials;
+    const std::size_t numBreakpoints = header.numBreakpoints;
+    const Layout layout( numPartials, numBreakpoints );
+    if ( header.fileBytes != layout.fileBytes || mapping->size() != layout.fileBytes )
+        Throw( FileIOException, "Bank file is damaged: " + filename );
+
+    //  only the Partial headers are checked, the synthesizer trusts them
+    //  to stay inside the Breakpoint arrays
+    const PartialStruct * partials = (const PartialStruct *) ( data + layout.partials );
+    const int * startOrder = (const int *) ( data + layout.startOrder );
+    const int * loudnessOrder = (const int *) ( data + layout.loudnessOrder );
+    for (std::size_t i = 0; i < numPartials; ++i)
+    {
+        const PartialStruct & p = partials[i];
+        if ( p.firstBreakpoint < 0 || p.numBreakpoints < 2 ||
+             (std::size_t) p.firstBreakpoint + p.numBreakpoints > numBreakpoints ||
+             (std::size_t) startOrder[i] >= numPartials || (std::size_t) loudnessOrder[i] >= numPartials )
+            Throw( FileIOException, "Bank file is damaged: " + filename );
+    }
+
+    RealtimePartialBank * bank = new RealtimePartialBank( header.fadeTime, header.sampleRate, header.maxActivePartials,
+                                                        header.noiseEnergy );
+    RealtimePartialBank::Ptr ptr( bank );
+
+    bank->m_partials = BankArray< PartialStruct >( partials, numPartials );
+    bank->m_startOrder = BankArray< int >( startOrder, numPartials );
+    bank->m_loudnessOrder = BankArray< int >( loudnessOrder, numPartials );
+
+    RealtimePartialBank::BreakpointArrays & b = bank->m_breakpoints;
+    b.sample = BankArray< int >( (const int *) ( data + layout.breakpoints[SampleArray] ), numBreakpoints );
+    b.frequency = BankArray< float >( (const float *) ( data + layout.breakpoints[FrequencyArray] ), numBreakpoints );
+    b.amplitude = BankArray< float >( (const float *) ( data + layout.breakpoints[AmplitudeArray] ), numBreakpoints );
+    b.bandwidth = BankArray< float >( (const float *) ( data + layout.breakpoints[BandwidthArray] ), numBreakpoints );
+    b.phase = BankArray< float >( (const float *) ( data + layout.breakpoints[PhaseArray] ), numBreakpoints );
+    b.frequencyIncrement = BankArray< float >( (const float *) ( data + layout.breakpoints[FrequencyIncrementArray] ), numBreakpoints );
+    b.amplitudeIncrement = BankArray< float >( (const float *) ( data + layout.breakpoints[AmplitudeIncrementArray] ), numBreakpoints );
+    b.bandwidthIncrement = BankArray< float >( (const float *) ( data + layout.breakpoints[BandwidthIncrementArray] ), numBreakpoints );
+
+    bank->m_storage = mapping;
+    return ptr;
+}
+
+// ---------------------------------------------------------------------------
+//	writeArray
+// ---------------------------------------------------------------------------
+//	Pad the file up to offset and write bytes of an array.
+//
+static void writeArray( std::ofstream & s, std::size_t offset, const void * data, std::size_t bytes )
+{
+    static const char zeros[CacheLine] = { 0 };
+
+    std::size_t position = (std::size_t) s.tellp();
+    if ( position < offset )
+        s.write( zeros, offset - position );
+    s.write( (const char *) data, bytes );
+}
+
+// ---------------------------------------------------------------------------
+//	write
+// ---------------------------------------------------------------------------
+//!	Write a bank into a file.
+//!
+//!	\param	filename The name of the bank file to create.
+//!	\param	bank The bank to store.
+//!	\throw	FileIOException if the file can not be written.
+//
+void
+RealtimeBankFile::write( const std::string & filename, const RealtimePartialBank & bank )
+{
+    if ( ! littleEndianSystem() )
+        Throw( FileIOException, "Bank files can only be used on little-endian systems." );
+
+    if ( ! bank.isComplete() )
+        Throw( InvalidArgument, "Only banks of complete Partials can be stored." );
+
+    const RealtimePartialBank::BreakpointArrays & b = bank.breakpoints();
+    const std::size_t numPartials = bank.partials().size();
+    const std::size_t numBreakpoints = b.size();
+    const Layout layout( numPartials, numBreakpoints );
+
+    FileHeader header;
+    std::memset( &header, 0, sizeof( header ) );
+    std::memcpy( header.magic, Magic, sizeof( Magic ) );
+    header.version = FormatVersion;
+    header.headerBytes = sizeof( FileHeader );
+    header.partialBytes = sizeof( PartialStruct );
+    header.numPartials = (int32_t) numPartials;
+    header.numBreakpoints = (int32_t) numBreakpoints;
+    header.maxActivePartials = bank.maxActivePartials();
+    header.fadeTime = bank.fadeTime();
+    header.sampleRate = bank.sampleRate();
+    header.noiseEnergy = bank.noiseEnergy();
+    header.fileBytes = layout.fileBytes;
+
+    std::ofstream s( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( ! s )
+        Throw( FileIOException, "Could not create bank file " + filename );
+
+    s.write( (const char *) &header, sizeof( header ) );
+    writeArray( s, layout.partials, bank.partials().data(), numPartials * sizeof( PartialStruct ) );
+    writeArray( s, layout.startOrder, bank.startOrder().data(), numPartials * sizeof( int ) );
+    writeArray( s, layout.loudnessOrder, bank.loudnessOrder().data(), numPartials * sizeof( int ) );
+
+    const void * arrays[NumBreakpointArrays] = {
+        b.sample.data(), b.frequency.data(), b.amplitude.data(), b.bandwidth.data(), b.phase.data(),
+        b.frequencyIncrement.data(), b.amplitudeIncrement.data(), b.bandwidthIncrement.data() };
+    for (int i = 0; i < NumBreakpointArrays; ++i)
+        writeArray( s, layout.breakpoints[i], arrays[i], numBreakpoints * 4 );
+    writeArray( s, layout.fileBytes, 0, 0 );
+
+    s.close();
+    if ( ! s )
+        Throw( FileIOException, "Could not write bank file " + filename );
+}
+
+// ---------------------------------------------------------------------------
+//	convertSdif
+// ---------------------------------------------------------------------------
+//!	Convert Partials of an SDIF file into a bank file. The Partials
+//!	are quantized to the sample rate (with phase correction) and
+//!	compiled like for a RealTimeSynthesizer.
+//!
+//!	\param	sdifFilename The name of the SDIF file to read.
+//!	\param	bankFilename The name of the bank file to create.
+//!	\param	sampleRate The sample rate in Hz to compile the bank for.
+//!	\param	fadeTime The Partial fade time in seconds.
+//!	\throw	FileIOException if either of the files can not be accessed.
+//
+void
+RealtimeBankFile::convertSdif( const std::string & sdifFilename, const std::string & bankFilename,
+                               double sampleRate, double fadeTime )
+{
+    SdifFile sdif( sdifFilename );
+    PartialList & partials = sdif.partials();
+
+    Resampler resampler( 1 / sampleRate );
+    resampler.setPhaseCorrect( true );
+    resampler.quantize( partials.begin(), partials.end() );
+
+    RealtimePartialBank bank( partials, fadeTime, sampleRate );
+    write( bankFilename, bank );
+}
+
+}   //  end of namespace Loris
@@ -0,0 +1,113 @@
+#ifndef INCLUDE_REALTIME_BANK_FILE_H
+#define INCLUDE_REALTIME_BANK_FILE_H
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimeBankFile.h
+ *
+ * Definition of class Loris::RealtimeBankFile, binary files holding
+ * compiled RealtimePartialBanks.
+ *
+ */
+
+#include "RealtimePartialBank.h"
+
+#include <string>
+
+//	begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//	class RealtimeBankFile
+//
+//!	Class RealtimeBankFile stores a RealtimePartialBank in a binary file
+//!	laid out exactly like the arrays of the bank, so that the file can be
+//!	mapped into memory and played without parsing or copying.
+//!
+//!	The file starts with a 64 byte header (all values little-endian):
+//!
+//!	    offset  type        contents
+//!	    0       char[8]     "LORISRTB"
+//!	    8       uint32      format version, 2
+//!	    12      uint32      header size, 64
+//!	    16      uint32      size of PartialStruct in bytes
+//!	    20      int32       number of Partials
+//!	    24      int32       number of Breakpoints
+//!	    28      int32       largest number of Partials sounding at once
+//!	    32      double      fade time in seconds
+//!	    40      double      sample rate in Hz
+//!	    48      uint64      file size in bytes
+//!	    56      float       noise share of the Breakpoint energy
+//!	    60      uint32      reserved, 0
+//!
+//!	The arrays follow in this order, each starting at a multiple of 64
+//!	bytes (a cache line): Partials (PartialStruct), start order and
+//!	loudness order (int32 per Partial), then Breakpoint sample indices
+//!	(int32), frequencies, amplitudes, bandwidths, phases, frequency,
+//!	amplitude and bandwidth increments (float per Breakpoint).
+//!
+//!	A bank is compiled for one sample rate, banks for another rate have
+//!	to be compiled again from the Partials.
+//
+class RealtimeBankFile
+{
+//	-- public interface --
+public:
+	//!	Map a bank file into memory. The returned bank uses the mapped
+	//!	arrays in place, the file stays mapped until the bank is destroyed.
+	//!
+	//!	\param	filename The name of the bank file.
+	//!	\return The mapped bank.
+	//!	\throw	FileIOException if the file can not be mapped or it is not
+	//!			a valid bank file of this format version.
+	static RealtimePartialBank::Ptr map( const std::string & filename );
+
+	//!	Write a bank into a file.
+	//!
+	//!	\param	filename The name of the bank file to create.
+	//!	\param	bank The bank to store.
+	//!	\throw	FileIOException if the file can not be written.
+	//!	\throw	InvalidArgument if the Partials of the bank are not complete.
+	static void write( const std::string & filename, const RealtimePartialBank & bank );
+
+	//!	Convert Partials of an SDIF file into a bank file. The Partials
+	//!	are quantized to the sample rate (with phase correction) and
+	//!	compiled like for a RealTimeSynthesizer.
+	//!
+	//!	\param	sdifFilename The name of the SDIF file to read.
+	//!	\param	bankFilename The name of the bank file to create.
+	//!	\param	sampleRate The sample rate in Hz to compile the bank for.
+	//!	\param	fadeTime The Partial fade time in seconds.
+	//!	\throw	FileIOException if either of the files can not be accessed.
+	static void convertSdif( const std::string & sdifFilename, const std::string & bankFilename,
+	                         double sampleRate, double fadeTime );
+
+//	-- implementation --
+private:
+	//	only static members
+	RealtimeBankFile( void );
+
+};	//	end of class RealtimeBankFile
+
+}	//	end of namespace Loris
+
+#endif /* ndef INCLUDE_REALTIME_BANK_FILE_H */
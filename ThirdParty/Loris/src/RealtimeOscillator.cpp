@@ -93,6 +93,20 @@ namespace Loris {
         m_filter.clear();
     }
     
+    // ---------------------------------------------------------------------------
+    //  restoreEnvelopes
+    // ---------------------------------------------------------------------------
+    //  Reset the instantaneous envelope parameters. Frequency is
+    //  in radians per sample and it is already scaled.
+    //
+    void
+    RealtimeOscillator::restoreEnvelopes( double frequency, double amplitude, double phase ) noexcept
+    {
+        m_instfrequency = frequency;
+        m_instamplitude = amplitude;
+        m_determphase = phase;
+    }
+
     // ---------------------------------------------------------------------------
     //  resetEnvelopes
     // ---------------------------------------------------------------------------
@@ -202,64 +216,57 @@ namespace Loris {
         }
         //  compute trajectories:
         const double dTime = 1. / dSample; //(end - begin);
-        const double dFreqOver2 = 0.5 * (targetFreq - m_instfrequency) * dTime;
+        
+        oscillate( begin, end, (targetFreq - m_instfrequency) * dTime, (targetAmp - m_instamplitude) * dTime );
+        
+        m_instbandwidth = targetBw;
+    }
+    
+    // ---------------------------------------------------------------------------
+    //  oscillate
+    // ---------------------------------------------------------------------------
+    //  Accumulate sinusoidal samples modulating the oscillator state from its
+    //  current values of radian frequency and amplitude by the specified
+    //  per-sample increments, into the specified half-open range of floats.
+    //  SSE2 instructions are used.
+    //
+    //  The caller must ensure that the range is valid. Increments are
+    //  not bounds-checked, no divisions are done here.
+    //
+    void
+    RealtimeOscillator::oscillate( float * begin, float * end, double dFreq, double dAmp ) noexcept
+    {
         //	split frequency update in two steps, update phase using average
         //	frequency, after adding only half the frequency step
+        const double dFreqOver2 = 0.5 * dFreq;
         
-        const double dAmp = (targetAmp - m_instamplitude)  * dTime;
-//        const double dBw = (targetBw - m_instbandwidth)  * dTime;
-        //  Use temporary local variables for speed.
-        //  Probably not worth it when I am computing square roots
-        //  and cosines...
-        double ph = m_determphase;
-//        double f = m_instfrequency;
-//        double a = m_instamplitude;
-//        double bw = m_instbandwidth;
-        
-        // Ignore bandwidth
-        //	Also use a more efficient sample loop when the bandwidth is zero.
-//        if (false 0 < bw || 0 < dBw )
-//        {
-//            double am, nz;
-//            for ( double * putItHere = begin; putItHere != end; ++putItHere )
-//            {
-//                //  use math functions in namespace std:
-//                using namespace std;
-//                
-//                //  compute amplitude modulation due to bandwidth:
-//                //
-//                //  This will give the right amplitude modulation when scaled
-//                //  by the Partial amplitude:
-//                //
-//                //  carrier amp: sqrt( 1. - bandwidth ) * amp
-//                //  modulation index: sqrt( 2. * bandwidth ) * amp
-//                //
-//                nz = m_filter.apply( m_modulator.sample() );
-//                am = sqrt( 1. - bw ) + ( nz * sqrt( 2. * bw ) );
-//                
-//                //  compute a sample and add it into the buffer:
-//                *putItHere += am * a * cos( ph );
-//                
-//                //  update the instantaneous oscillator state:
-//                f += dFreqOver2;
-//                ph += f;   //  frequency is radians per sample
-//                f += dFreqOver2;
-//                a += dAmp;
-//                bw += dBw;
-//                if (bw < 0.)
-//                {
-//                    bw = 0.;
-//                }
-//            }   // end of sample computation loop
-//        }
-//        else
+        //  Vectorized loop
+        double a4[4] = { m_instamplitude };
+        double f4[4] = { m_instfrequency };
+        V4SF ph4 = { (float) m_determphase };
+
+        for (int i = 1; i < 4; i++)
         {
-//          Vectorized loop
-            
-            double a4[4] = { m_instamplitude };
-            double f4[4] = { m_instfrequency };
-            V4SF ph4 = { (float) m_determphase };
+            f4[i] = f4[i - 1] + dFreqOver2;
+            ph4.f[i] = ph4.f[i - 1] + f4[i];
+            f4[i] = f4[i] + dFreqOver2;
+            a4[i] = a4[i - 1] + dAmp;
+        }
 
+        V4SF cosVal;
+        float * putItHere = begin;
+        for ( ; putItHere + 4  < end; putItHere += 4 )
+        {
+            cosVal.v = cos_ps(ph4.v);
+            for (int i = 0; i < 4; i++)
+            {
+                putItHere[i] += (a4[i] == 0 ? 0 : a4[i] * cosVal.f[i]);
+            }
+
+            f4[0] = f4[3] + dFreqOver2;
+            ph4.f[0] = ph4.f[3] + f4[0];
+            f4[0] = f4[0] + dFreqOver2;
+            a4[0] = a4[3] + dAmp;
             for (int i = 1; i < 4; i++)
             {
                 f4[i] = f4[i - 1] + dFreqOver2;
@@ -267,68 +274,32 @@ namespace Loris {
                 f4[i] = f4[i] + dFreqOver2;
                 a4[i] = a4[i - 1] + dAmp;
             }
+        }   // end of sample computation loop
 
-            V4SF cosVal;
-            float * putItHere = begin;
-            for ( ; putItHere + 4  < end; putItHere += 4 )
-            {
-                cosVal.v = cos_ps(ph4.v);
-                for (int i = 0; i < 4; i++)
-                {
-                    putItHere[i] += (a4[i] == 0 ? 0 : a4[i] * cosVal.f[i]);
-                }
-
-                f4[0] = f4[3] + dFreqOver2;
-                ph4.f[0] = ph4.f[3] + f4[0];
-                f4[0] = f4[0] + dFreqOver2;
-                a4[0] = a4[3] + dAmp;
-                for (int i = 1; i < 4; i++)
-                {
-                    f4[i] = f4[i - 1] + dFreqOver2;
-                    ph4.f[i] = ph4.f[i - 1] + f4[i];
-                    f4[i] = f4[i] + dFreqOver2;
-                    a4[i] = a4[i - 1] + dAmp;
-                }
-            }   // end of sample computation loop
-
-            for ( ; putItHere != end; ++putItHere )
-            {
-                //  use math functions in namespace std:
-                using namespace std;
-
-                //	no modulation when there is no bandwidth
-
-                //  compute a sample and add it into the buffer:
-                *putItHere += (a4[0] == 0 ? 0 : a4[0] * cos(ph4.f[0]));
-
-
-                //  update the instantaneous oscillator state:
-                f4[0] += dFreqOver2;
-                ph4.f[0] += f4[0];   //  frequency is radians per sample
-                f4[0] += dFreqOver2;
-                a4[0] += dAmp;
+        for ( ; putItHere != end; ++putItHere )
+        {
+            //  use math functions in namespace std:
+            using namespace std;
 
-            }   // end of
+            //  compute a sample and add it into the buffer:
+            *putItHere += (a4[0] == 0 ? 0 : a4[0] * cos(ph4.f[0]));
 
-            ph = ph4.f[0];
-            targetAmp = a4[0];
-            targetFreq = f4[0];
-            
+            //  update the instantaneous oscillator state:
+            f4[0] += dFreqOver2;
+            ph4.f[0] += f4[0];   //  frequency is radians per sample
+            f4[0] += dFreqOver2;
+            a4[0] += dAmp;
         }
         
         //  wrap phase to prevent eventual loss of precision at
         //  high oscillation frequencies:
         //  (Doesn't really matter much exactly how we wrap it,
         //  as long as it brings the phase nearer to zero.)
-        m_determphase = m2pi( ph );
+        m_determphase = m2pi( ph4.f[0] );
         
-        //  set the state variables to their target values,
-        //  just in case they didn't arrive exactly (overshooting
-        //  amplitude or, especially, bandwidth, could be bad, and
-        //  it does happen):
-        m_instfrequency = targetFreq;
-        m_instamplitude = targetAmp;
-        m_instbandwidth = targetBw;
+        //  set the state variables to their values at end
+        m_instfrequency = f4[0];
+        m_instamplitude = a4[0];
     }
     
 }   //  end of namespace Loris
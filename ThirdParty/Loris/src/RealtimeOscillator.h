@@ -96,6 +96,11 @@ public:
     //! The Breakpoint frequency (Hz) is in radians per sample
     //! and is scaled by frequency scaling.
     void restoreEnvelopes( const Breakpoint & bp) noexcept;
+
+    //! Reset the instantaneous envelope parameters. Frequency is
+    //! in radians per sample and it is already scaled, no bounds
+    //! checking is done.
+    void restoreEnvelopes( double frequency, double amplitude, double phase ) noexcept;
     
     //! Set internal frequency scaling.
     void setFrequencyScaling( double scaling ) noexcept;
@@ -109,6 +114,13 @@ public:
     //! checked to prevent aliasing and bogus bandwidth enhancement.
     void oscillate( float * begin, float * end, const Breakpoint & bp, double srate, int dSample ) noexcept;
 
+    //! Accumulate sinusoidal samples modulating the oscillator state from its
+    //! current values of radian frequency and amplitude by the specified
+    //! per-sample increments. Accumulate samples into the half-open range of
+    //! floats, starting at begin, and ending before end. The caller must insure
+    //! that the range is valid and the increments are bounds-checked.
+    void oscillate( float * begin, float * end, double dFreq, double dAmp ) noexcept;
+
 // --- accessors ---
 
     //! Return the instantaneous envelope parameters
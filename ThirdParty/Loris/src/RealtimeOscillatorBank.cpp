@@ -0,0 +1,814 @@
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimeOscillatorBank.C
+ *
+ * Implementation of class Loris::RealtimeOscillatorBank, renders many
+ * sinusoidal Partials at once, one Partial per SIMD lane.
+ *
+ */
+#if HAVE_CONFIG_H
+    #include "config.h"
+#endif
+#include "RealtimeOscillatorBank.h"
+#include "RealtimeSynthesizer.h"  //  Pi
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+//  The lane kernels are written with GCC vector extensions (GCC and clang)
+//  and compiled for each instruction set using target attributes, so no
+//  special compiler flags are needed for this file.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define LORIS_OSCILLATOR_BANK_LANES 1
+    #define LORIS_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+    #define LORIS_OSCILLATOR_BANK_LANES 0
+    #define LORIS_ALWAYS_INLINE inline
+#endif
+
+//  begin namespace
+namespace Loris {
+
+typedef RealtimeOscillatorBank::Segment Segment;
+typedef RealtimeOscillatorBank::Run Run;
+
+//  Lowpass filter of the bandwidth-enhancement noise, the same Chebychev
+//  filter as Oscillator::prototype_filter(), order 3, cutoff 500, ripple -1.
+//  The feed-forward coefficients are 1, 3, 3, 1. The gain includes the
+//  standard deviation of NoiseGenerator samples (0.944, not 1) so the
+//  noise level matches the Synthesizer.
+static const double NoiseFilterGain = 0.944 * 6. / 4.663939184e+04;
+static const double NoiseFilterA1 = -2.9258684252;
+static const double NoiseFilterA2 = 2.8580608586;
+static const double NoiseFilterA3 = -0.9320209046;
+
+// ---------------------------------------------------------------------------
+//  RealtimeOscillatorBank constructor
+// ---------------------------------------------------------------------------
+//  Construct an empty bank in Rotator mode using the best
+//  instruction set supported by this CPU.
+//
+RealtimeOscillatorBank::RealtimeOscillatorBank( void ) :
+    m_position( 0 ),
+    m_instructionSet( detectInstructionSet() ),
+    m_mode( Rotator )
+{
+}
+
+// ---------------------------------------------------------------------------
+//  prepare
+// ---------------------------------------------------------------------------
+//  Preallocate memory for blocks of up to maxSamples samples and
+//  approximately numSegments segments so that rendering does not
+//  allocate.
+//
+void
+RealtimeOscillatorBank::prepare( int maxSamples, int numSegments )
+{
+    //  a run has at least one segment
+    m_segments.reserve( numSegments );
+    m_runs.reserve( numSegments );
+    if ( (int) m_scratch.size() < 16 * maxSamples + 16 )
+        m_scratch.resize( 16 * maxSamples + 16 );
+    if ( (int) m_noise.size() < 16 * maxSamples + 48 )
+        m_noise.resize( 16 * maxSamples + 48 );
+}
+
+// ---------------------------------------------------------------------------
+//  addSegment
+// ---------------------------------------------------------------------------
+//  Add a segment to the current run.
+//
+void
+RealtimeOscillatorBank::addSegment( int offset, int length, double phase,
+                                    double frequency, double dFrequency,
+                                    double amplitude, double dAmplitude,
+                                    double bandwidth, double dBandwidth )
+{
+    Segment s;
+    s.offset = offset;
+    s.end = offset + length;
+    s.phase = phase;
+    s.frequency = frequency;
+    s.dFrequency = dFrequency;
+    s.amplitude = amplitude;
+    s.dAmplitude = dAmplitude;
+    s.bandwidth = bandwidth;
+    s.dBandwidth = dBandwidth;
+    assert( m_segments.size() < m_segments.capacity() );
+    m_segments.push_back( s );
+
+    if ( ( bandwidth > 0. || dBandwidth > 0. ) && m_runs.back().noise )
+        m_runs.back().noisy = true;
+}
+
+// ---------------------------------------------------------------------------
+//  mixBits
+// ---------------------------------------------------------------------------
+//  32 bit integer hash with good avalanche (lowbias32 by C. Wellons),
+//  for scalars and unsigned vectors alike, vectors are hashed in place
+//  so that no wide vector is returned. Hashing a counter gives a
+//  counter-based random number generator: any sample of the sequence is
+//  computed directly, independently of the others.
+//
+template< typename U >
+static LORIS_ALWAYS_INLINE void mixBitsInPlace( U & x )
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+}
+
+static LORIS_ALWAYS_INLINE uint32_t mixBits( uint32_t bits )
+{
+    mixBitsInPlace( bits );
+    return bits;
+}
+
+// ---------------------------------------------------------------------------
+//  scalarNoise
+// ---------------------------------------------------------------------------
+//  Lowpass filtered Gaussian noise of one Partial for samples samples
+//  from position on. Pair c of Gaussian numbers is obtained by the
+//  Box-Muller transformation of uniform numbers hashed from counters 2c
+//  and 2c + 1 and the key, the pair is used by samples 2c and 2c + 1.
+//  The angle is drawn from the first quadrant, the two lowest bits of
+//  the second hash choose the signs of the pair.
+//
+static void
+scalarNoise( uint32_t key, uint32_t position, int samples, float * filter, float * noise )
+{
+    key = mixBits( key );
+
+    double w1 = filter[0], w2 = filter[1], w3 = filter[2];
+    double z[2] = { 0., 0. };
+    for ( int i = 0; i < samples; ++i )
+    {
+        uint32_t p = position + i;
+        if ( i == 0 || ( p & 1 ) == 0 )
+        {
+            uint32_t c = p >> 1;
+            uint32_t h1 = mixBits( mixBits( 2 * c ) ^ key );
+            uint32_t h2 = mixBits( mixBits( 2 * c + 1 ) ^ key );
+            double u1 = ( ( h1 >> 8 ) + 0.5 ) * ( 1. / 16777216 );
+            double phi = ( h2 >> 8 ) * ( 0.5 * Pi / 16777216 );
+            double r = std::sqrt( -2. * std::log( u1 ) );
+            z[0] = ( h2 & 1 ) ? -r * std::cos( phi ) : r * std::cos( phi );
+            z[1] = ( h2 & 2 ) ? -r * std::sin( phi ) : r * std::sin( phi );
+        }
+        double x = z[p & 1];
+
+        double w0 = x - NoiseFilterA1 * w1 - NoiseFilterA2 * w2 - NoiseFilterA3 * w3;
+        noise[i] = NoiseFilterGain * ( w0 + 3. * ( w1 + w2 ) + w3 );
+        w3 = w2;
+        w2 = w1;
+        w1 = w0;
+    }
+
+    filter[0] = w1;
+    filter[1] = w2;
+    filter[2] = w3;
+}
+
+// ---------------------------------------------------------------------------
+//  renderScalar
+// ---------------------------------------------------------------------------
+//  Reference implementation, one segment after another in double precision.
+//
+static void
+renderScalar( RealtimeOscillatorBank::Mode mode, const Segment * segs, const Run * runs,
+              int numRuns, int numSegs, uint32_t position, float * noise, float * buffer, int samples )
+{
+    for ( const Run * run = runs; run != runs + numRuns; ++run )
+    {
+        const Segment * last = ( run + 1 != runs + numRuns ) ? segs + run[1].first : segs + numSegs;
+
+        if ( run->noisy )
+            scalarNoise( run->noise->key, position, samples, run->noise->filter, noise );
+
+        for ( const Segment * s = segs + run->first; s != last; ++s )
+        {
+            double ph = s->phase;
+            double f = s->frequency;
+            double a = s->amplitude;
+            double bw = s->bandwidth;
+            const double dFreqOver2 = 0.5 * s->dFrequency;
+
+            //  phase increment of sample k is f + dFreqOver2 + k * dFrequency,
+            //  so the rotator is itself rotated by dFrequency every sample
+            double re = std::cos( ph ), im = std::sin( ph );
+            double wre = std::cos( f + dFreqOver2 ), wim = std::sin( f + dFreqOver2 );
+            const double gre = std::cos( s->dFrequency ), gim = std::sin( s->dFrequency );
+
+            for ( int t = s->offset; t != s->end; ++t )
+            {
+                //  amplitude modulation due to bandwidth, as in Oscillator
+                double am = 1.;
+                if ( run->noisy )
+                {
+                    bw = std::min( std::max( bw, 0. ), 1. );
+                    am = std::sqrt( 1. - bw ) + noise[t] * std::sqrt( 2. * bw );
+                    bw += s->dBandwidth;
+                }
+
+                if ( mode == RealtimeOscillatorBank::Rotator )
+                {
+                    buffer[t] += am * a * re;
+                    double tmp = re * wre - im * wim;
+                    im = re * wim + im * wre;
+                    re = tmp;
+                    tmp = wre * gre - wim * gim;
+                    wim = wre * gim + wim * gre;
+                    wre = tmp;
+                }
+                else
+                {
+                    buffer[t] += am * a * std::cos( ph );
+                    f += dFreqOver2;
+                    ph += f;
+                    f += dFreqOver2;
+                }
+                a += s->dAmplitude;
+            }
+        }
+    }
+}
+
+#if LORIS_OSCILLATOR_BANK_LANES
+
+//  vectors wider than SSE are never passed to functions that are
+//  not inlined, do not warn about their ABI in the lane kernels. The
+//  helpers transform vectors in place instead of returning them, GCC
+//  reports vector returns at the end of the file where this does not
+//  apply.
+#if !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+typedef float FloatLanes4 __attribute__((vector_size(16)));
+typedef int IntLanes4 __attribute__((vector_size(16)));
+typedef unsigned UIntLanes4 __attribute__((vector_size(16)));
+typedef float FloatLanes8 __attribute__((vector_size(32)));
+typedef int IntLanes8 __attribute__((vector_size(32)));
+typedef unsigned UIntLanes8 __attribute__((vector_size(32)));
+typedef float FloatLanes16 __attribute__((vector_size(64)));
+typedef int IntLanes16 __attribute__((vector_size(64)));
+typedef unsigned UIntLanes16 __attribute__((vector_size(64)));
+
+// ---------------------------------------------------------------------------
+//  wrapLanes
+// ---------------------------------------------------------------------------
+//  Wrap phases to the range [-Pi, Pi] in place, round half away from zero.
+//
+template< typename V, typename VI >
+static LORIS_ALWAYS_INLINE void wrapLanes( V & x )
+{
+    const VI signMask = VI() + (int) 0x80000000;
+    V q = x * (float) ( 1. / ( 2 * Pi ) );
+    V half = (V) ( ( (VI) q & signMask ) | (VI) ( V() + 0.5f ) );
+    V k = __builtin_convertvector( __builtin_convertvector( q + half, VI ), V );
+    x -= k * (float) ( 2 * Pi );
+}
+
+// ---------------------------------------------------------------------------
+//  cosLanes
+// ---------------------------------------------------------------------------
+//  Cosine of phases in the range [-Pi, Pi], in place. The argument is
+//  folded to [0, Pi/2] where a Taylor polynomial is accurate to float
+//  precision.
+//
+template< typename V, typename VI >
+static LORIS_ALWAYS_INLINE void cosLanes( V & x )
+{
+    const VI signMask = VI() + (int) 0x80000000;
+    V ax = (V) ( (VI) x & ~signMask );
+    VI fold = ax > (float) ( 0.5 * Pi );
+    V y = (V) ( ( fold & (VI) ( (float) Pi - ax ) ) | ( ~fold & (VI) ax ) );
+    V z = y * y;
+    V c = 1.f + z * ( -1.f / 2 + z * ( 1.f / 24 + z * ( -1.f / 720 + z * ( 1.f / 40320
+                + z * ( -1.f / 3628800 + z * ( 1.f / 479001600 ) ) ) ) ) );
+    x = (V) ( (VI) c ^ ( fold & signMask ) );
+}
+
+// ---------------------------------------------------------------------------
+//  log2Lanes
+// ---------------------------------------------------------------------------
+//  Base 2 logarithm of positive normal numbers in place, accurate to
+//  1e-5. The mantissa m in [1, 2) is evaluated by ( m - 1 ) times a
+//  polynomial, so the logarithm of 1 is exact.
+//
+template< typename V, typename VI >
+static LORIS_ALWAYS_INLINE void log2Lanes( V & x )
+{
+    VI bits = (VI) x;
+    VI e = ( bits >> 23 ) - 127;
+    V t = (V) ( ( bits & 0x007fffff ) | 0x3f800000 ) - 1.f;
+    V p = 1.44268147f + t * ( -0.720358773f + t * ( 0.468658879f + t * ( -0.30163801f
+                + t * ( 0.144471096f + t * ( -0.033822046f ) ) ) ) );
+    x = __builtin_convertvector( e, V ) + t * p;
+}
+
+// ---------------------------------------------------------------------------
+//  sqrtLanes
+// ---------------------------------------------------------------------------
+//  Square root of positive numbers in place by Newton iteration of
+//  the reciprocal square root started from the bit level estimate,
+//  accurate to 1e-5. The root of 0 may come out as NaN.
+//
+template< typename V, typename VI >
+static LORIS_ALWAYS_INLINE void sqrtLanes( V & x )
+{
+    V y = (V) ( 0x5f3759df - ( (VI) x >> 1 ) );
+    y = y * ( 1.5f - 0.5f * x * y * y );
+    y = y * ( 1.5f - 0.5f * x * y * y );
+    x *= y;
+}
+
+// ---------------------------------------------------------------------------
+//  noiseLanes
+// ---------------------------------------------------------------------------
+//  Lowpass filtered Gaussian noise of a block, one Partial per lane, the
+//  same sequence as scalarNoise() in float precision. The Gaussian pairs
+//  are generated first, the filter runs over the whole block after that.
+//  Return the noise of the first sample, noise has to hold samples + 2
+//  vectors.
+//
+template< typename V, typename VI, typename VU >
+static LORIS_ALWAYS_INLINE const V *
+noiseLanes( const VU & key, uint32_t position, int samples, V * w, V * noise )
+{
+    const VI signMask = VI() + (int) 0x80000000;
+    const uint32_t first = position >> 1;
+    const uint32_t pairs = ( ( position + samples - 1 ) >> 1 ) - first + 1;
+    for ( uint32_t k = 0; k < pairs; ++k )
+    {
+        uint32_t c = first + k;
+        VU h1 = mixBits( 2 * c ) ^ key;
+        VU h2 = mixBits( 2 * c + 1 ) ^ key;
+        mixBitsInPlace( h1 );
+        mixBitsInPlace( h2 );
+        V u1 = ( __builtin_convertvector( (VI) ( h1 >> 8 ), V ) + 0.5f ) * ( 1.f / 16777216 );
+        V phi = __builtin_convertvector( (VI) ( h2 >> 8 ), V ) * (float) ( 0.5 * Pi / 16777216 );
+
+        //  -2 ln( u1 ), the polynomial may overshoot 0 near u1 = 1. The
+        //  root is masked after it is taken, the root of 0 overflows when
+        //  -ffast-math reorders the Newton step.
+        log2Lanes< V, VI >( u1 );
+        V s = -2.f * (float) std::log( 2. ) * u1;
+        V r = s;
+        sqrtLanes< V, VI >( r );
+        r = (V) ( (VI) r & ( s > 0.f ) );
+
+        //  Taylor polynomials are accurate to float precision in the first quadrant
+        V z = phi * phi;
+        V cs = 1.f + z * ( -1.f / 2 + z * ( 1.f / 24 + z * ( -1.f / 720 + z * ( 1.f / 40320
+                    + z * ( -1.f / 3628800 ) ) ) ) );
+        V sn = phi * ( 1.f + z * ( -1.f / 6 + z * ( 1.f / 120 + z * ( -1.f / 5040 + z * ( 1.f / 362880
+                    + z * ( -1.f / 39916800 ) ) ) ) ) );
+        noise[2 * k] = (V) ( (VI) ( r * cs ) ^ ( (VI) ( h2 << 31 ) & signMask ) );
+        noise[2 * k + 1] = (V) ( (VI) ( r * sn ) ^ ( (VI) ( h2 << 30 ) & signMask ) );
+    }
+
+    noise += position & 1;
+    V w1 = w[0], w2 = w[1], w3 = w[2];
+    for ( int t = 0; t < samples; ++t )
+    {
+        V w0 = noise[t] - (float) NoiseFilterA1 * w1 - (float) NoiseFilterA2 * w2 - (float) NoiseFilterA3 * w3;
+        noise[t] = (float) NoiseFilterGain * ( w0 + 3.f * ( w1 + w2 ) + w3 );
+        w3 = w2;
+        w2 = w1;
+        w1 = w0;
+    }
+    w[0] = w1;
+    w[1] = w2;
+    w[2] = w3;
+
+    return noise;
+}
+
+// ---------------------------------------------------------------------------
+//  EnvelopeLanes
+// ---------------------------------------------------------------------------
+//  Amplitude of oscillator lanes. With noise, the amplitude is modulated
+//  as in Oscillator by sqrt( 1 - bandwidth ) + noise * sqrt( 2 * bandwidth ),
+//  both square roots are interpolated linearly over the segment.
+//
+template< typename V >
+struct EnvelopeLanes
+{
+    V a, da, c, dc, m, dm;
+
+    LORIS_ALWAYS_INLINE EnvelopeLanes( void ) : a(), da(), c(), dc(), m(), dm() {}
+
+    LORIS_ALWAYS_INLINE void load( int l, const Segment & s )
+    {
+        a[l] = s.amplitude;
+        da[l] = s.dAmplitude;
+        c[l] = 1.f;
+        dc[l] = m[l] = dm[l] = 0.f;
+        if ( s.bandwidth > 0.f || s.dBandwidth > 0.f )
+        {
+            double n = s.end - s.offset;
+            double bw0 = std::min( std::max( (double) s.bandwidth, 0. ), 1. );
+            double bw1 = std::min( std::max( s.bandwidth + n * s.dBandwidth, 0. ), 1. );
+            c[l] = std::sqrt( 1. - bw0 );
+            dc[l] = ( std::sqrt( 1. - bw1 ) - c[l] ) / n;
+            m[l] = std::sqrt( 2. * bw0 );
+            dm[l] = ( std::sqrt( 2. * bw1 ) - m[l] ) / n;
+        }
+    }
+
+    LORIS_ALWAYS_INLINE void silence( int l ) { a[l] = da[l] = 0.f; }
+
+    //  scale x by the amplitude of sample t and advance
+    template< bool Noisy >
+    LORIS_ALWAYS_INLINE void apply( V & x, const V * noise, int t )
+    {
+        V g = a;
+        if ( Noisy )
+        {
+            g *= c + m * noise[t];
+            c += dc;
+            m += dm;
+        }
+        a += da;
+        x *= g;
+    }
+};
+
+// ---------------------------------------------------------------------------
+//  CosineLanes
+// ---------------------------------------------------------------------------
+//  Oscillator lanes accumulating phase and evaluating cosine every sample.
+//
+template< typename V, typename VI >
+struct CosineLanes
+{
+    V ph, f, hdf;
+    EnvelopeLanes< V > env;
+
+    LORIS_ALWAYS_INLINE CosineLanes( void ) : ph(), f(), hdf() {}
+
+    LORIS_ALWAYS_INLINE void load( int l, const Segment & s )
+    {
+        ph[l] = s.phase;
+        f[l] = s.frequency;
+        hdf[l] = 0.5f * s.dFrequency;
+        env.load( l, s );
+    }
+
+    LORIS_ALWAYS_INLINE void silence( int l ) { env.silence( l ); }
+
+    template< bool Noisy >
+    LORIS_ALWAYS_INLINE void run( V * acc, const V * noise, int begin, int end )
+    {
+        for ( int t = begin; t < end; ++t )
+        {
+            wrapLanes< V, VI >( ph );
+            V y = ph;
+            cosLanes< V, VI >( y );
+            env.template apply< Noisy >( y, noise, t );
+            acc[t] += y;
+
+            //  update the instantaneous oscillator state:
+            f += hdf;
+            ph += f;   //  frequency is radians per sample
+            f += hdf;
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+//  RotatorLanes
+// ---------------------------------------------------------------------------
+//  Oscillator lanes advancing a complex phasor by a complex rotator, a few
+//  multiply-adds per sample and no cosine. The frequency glide of a segment
+//  is applied by rotating the rotator itself. Both are set up in double
+//  precision from the segment phase and renormalized every RenormInterval
+//  samples so their magnitude does not drift.
+//
+template< typename V, typename VI >
+struct RotatorLanes
+{
+    enum { RenormInterval = 64 };
+
+    V re, im, wre, wim, gre, gim;
+    EnvelopeLanes< V > env;
+
+    LORIS_ALWAYS_INLINE RotatorLanes( void ) :
+        re(), im(), wre(), wim(), gre(), gim() {}
+
+    LORIS_ALWAYS_INLINE void load( int l, const Segment & s )
+    {
+        const double w = (double) s.frequency + 0.5 * s.dFrequency;
+        re[l] = std::cos( (double) s.phase );
+        im[l] = std::sin( (double) s.phase );
+        wre[l] = std::cos( w );
+        wim[l] = std::sin( w );
+        gre[l] = std::cos( (double) s.dFrequency );
+        gim[l] = std::sin( (double) s.dFrequency );
+        env.load( l, s );
+    }
+
+    LORIS_ALWAYS_INLINE void silence( int l ) { env.silence( l ); }
+
+    template< bool Noisy >
+    LORIS_ALWAYS_INLINE void run( V * acc, const V * noise, int begin, int end )
+    {
+        while ( begin < end )
+        {
+            int stop = std::min( end, begin + (int) RenormInterval );
+            for ( int t = begin; t < stop; ++t )
+            {
+                V y = re;
+                env.template apply< Noisy >( y, noise, t );
+                acc[t] += y;
+
+                V tmp = re * wre - im * wim;
+                im = re * wim + im * wre;
+                re = tmp;
+                tmp = wre * gre - wim * gim;
+                wim = wre * gim + wim * gre;
+                wre = tmp;
+            }
+            begin = stop;
+
+            //  first order correction of magnitude, both are close to 1
+            V k = 1.5f - 0.5f * ( re * re + im * im );
+            re *= k;
+            im *= k;
+            k = 1.5f - 0.5f * ( wre * wre + wim * wim );
+            wre *= k;
+            wim *= k;
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+//  renderLanes
+// ---------------------------------------------------------------------------
+//  Render runs of segments, W runs in lockstep. Every lane keeps its own
+//  oscillator state, lanes without a segment at the current sample have
+//  zero amplitude. The lanes are accumulated into a vector per sample,
+//  the horizontal sum is done only once per block.
+//
+//  Samples are rendered in spans between segment boundaries of any lane,
+//  the inner loop is branch free. The noise is generated only for groups
+//  with a bandwidth-enhanced run.
+//
+template< typename V, typename VI, typename VU, int W, typename Lanes >
+static LORIS_ALWAYS_INLINE void
+renderLanes( const Segment * segs, const Run * runs, int numRuns, int numSegs,
+             uint32_t position, float * scratch, float * noiseScratch, float * buffer, int samples )
+{
+    V * acc = reinterpret_cast< V * >( ( reinterpret_cast< uintptr_t >( scratch ) + 63 ) & ~uintptr_t( 63 ) );
+    V * noiseBuffer = reinterpret_cast< V * >( ( reinterpret_cast< uintptr_t >( noiseScratch ) + 63 ) & ~uintptr_t( 63 ) );
+    std::memset( acc, 0, samples * sizeof( V ) );
+
+    for ( int g = 0; g < numRuns; g += W )
+    {
+        int seg[W], last[W], event[W];
+        bool inside[W];
+        bool noisy = false;
+        Lanes lanes;
+
+        for ( int l = 0; l < W; ++l )
+        {
+            seg[l] = last[l] = 0;
+            if ( g + l < numRuns )
+            {
+                seg[l] = runs[g + l].first;
+                last[l] = ( g + l + 1 < numRuns ) ? runs[g + l + 1].first : numSegs;
+                noisy = noisy || runs[g + l].noisy;
+            }
+            event[l] = ( seg[l] < last[l] ) ? segs[seg[l]].offset : samples;
+            inside[l] = false;
+        }
+
+        const V * noise = 0;
+        if ( noisy )
+        {
+            VU key = VU();
+            V w[3] = { V(), V(), V() };
+            for ( int l = 0; l < W && g + l < numRuns; ++l )
+            {
+                if ( runs[g + l].noisy )
+                {
+                    const RealtimeOscillatorBank::Noise * n = runs[g + l].noise;
+                    key[l] = mixBits( n->key );
+                    w[0][l] = n->filter[0];
+                    w[1][l] = n->filter[1];
+                    w[2][l] = n->filter[2];
+                }
+            }
+
+            noise = noiseLanes< V, VI, VU >( key, position, samples, w, noiseBuffer );
+
+            for ( int l = 0; l < W && g + l < numRuns; ++l )
+            {
+                if ( runs[g + l].noisy )
+                {
+                    RealtimeOscillatorBank::Noise * n = runs[g + l].noise;
+                    n->filter[0] = w[0][l];
+                    n->filter[1] = w[1][l];
+                    n->filter[2] = w[2][l];
+                }
+            }
+        }
+
+        int t = 0;
+        for (;;)
+        {
+            //  switch segments of lanes reaching a boundary
+            int stop = samples;
+            for ( int l = 0; l < W; ++l )
+            {
+                if ( event[l] == t && t < samples )
+                {
+                    if ( inside[l] )
+                    {
+                        ++seg[l];
+                        inside[l] = false;
+                        lanes.silence( l );
+                    }
+                    if ( seg[l] < last[l] && segs[seg[l]].offset == t )
+                    {
+                        lanes.load( l, segs[seg[l]] );
+                        inside[l] = true;
+                        event[l] = segs[seg[l]].end;
+                    }
+                    else
+                    {
+                        event[l] = ( seg[l] < last[l] ) ? segs[seg[l]].offset : samples;
+                    }
+                }
+                stop = std::min( stop, event[l] );
+            }
+
+            if ( t >= samples )
+                break;
+
+            if ( noisy )
+                lanes.template run< true >( acc, noise, t, stop );
+            else
+                lanes.template run< false >( acc, noise, t, stop );
+            t = stop;
+        }
+    }
+
+    for ( int t = 0; t < samples; ++t )
+    {
+        float sum = 0.f;
+        for ( int l = 0; l < W; ++l )
+            sum += acc[t][l];
+        buffer[t] += sum;
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  renderWidth
+// ---------------------------------------------------------------------------
+//  Render with lanes of given width in the selected mode.
+//
+template< typename V, typename VI, typename VU, int W >
+static LORIS_ALWAYS_INLINE void
+renderWidth( RealtimeOscillatorBank::Mode mode,
+             const Segment * segs, const Run * runs, int numRuns, int numSegs,
+             uint32_t position, float * scratch, float * noise, float * buffer, int samples )
+{
+    if ( mode == RealtimeOscillatorBank::Rotator )
+        renderLanes< V, VI, VU, W, RotatorLanes< V, VI > >( segs, runs, numRuns, numSegs, position, scratch, noise, buffer, samples );
+    else
+        renderLanes< V, VI, VU, W, CosineLanes< V, VI > >( segs, runs, numRuns, numSegs, position, scratch, noise, buffer, samples );
+}
+
+static void
+renderSSE2( RealtimeOscillatorBank::Mode mode,
+            const Segment * segs, const Run * runs, int numRuns, int numSegs,
+            uint32_t position, float * scratch, float * noise, float * buffer, int samples )
+{
+    renderWidth< FloatLanes4, IntLanes4, UIntLanes4, 4 >( mode, segs, runs, numRuns, numSegs, position, scratch, noise, buffer, samples );
+}
+
+__attribute__((target("avx2,fma"))) static void
+renderAVX2( RealtimeOscillatorBank::Mode mode,
+            const Segment * segs, const Run * runs, int numRuns, int numSegs,
+            uint32_t position, float * scratch, float * noise, float * buffer, int samples )
+{
+    renderWidth< FloatLanes8, IntLanes8, UIntLanes8, 8 >( mode, segs, runs, numRuns, numSegs, position, scratch, noise, buffer, samples );
+}
+
+__attribute__((target("avx512f"))) static void
+renderAVX512( RealtimeOscillatorBank::Mode mode,
+              const Segment * segs, const Run * runs, int numRuns, int numSegs,
+              uint32_t position, float * scratch, float * noise, float * buffer, int samples )
+{
+    renderWidth< FloatLanes16, IntLanes16, UIntLanes16, 16 >( mode, segs, runs, numRuns, numSegs, position, scratch, noise, buffer, samples );
+}
+
+#if !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+#endif  //  LORIS_OSCILLATOR_BANK_LANES
+
+// ---------------------------------------------------------------------------
+//  render
+// ---------------------------------------------------------------------------
+//  Accumulate all collected segments into buffer.
+//
+void
+RealtimeOscillatorBank::render( float * buffer, int samples ) noexcept
+{
+    if ( m_segments.empty() )
+        return;
+
+    //  sized by prepare(), never on the audio thread
+#if LORIS_OSCILLATOR_BANK_LANES
+    assert( (int) m_scratch.size() >= 16 * samples + 16 );
+#endif
+    assert( (int) m_noise.size() >= 16 * samples + 48 );
+
+    const Segment * segs = m_segments.data();
+    const Run * runs = m_runs.data();
+    int numRuns = (int) m_runs.size();
+    int numSegs = (int) m_segments.size();
+
+#if LORIS_OSCILLATOR_BANK_LANES
+    switch ( m_instructionSet )
+    {
+        case AVX512:
+            renderAVX512( m_mode, segs, runs, numRuns, numSegs, m_position, m_scratch.data(), m_noise.data(), buffer, samples );
+            return;
+        case AVX2:
+            renderAVX2( m_mode, segs, runs, numRuns, numSegs, m_position, m_scratch.data(), m_noise.data(), buffer, samples );
+            return;
+        case SSE2:
+            renderSSE2( m_mode, segs, runs, numRuns, numSegs, m_position, m_scratch.data(), m_noise.data(), buffer, samples );
+            return;
+        default:
+            break;
+    }
+#endif
+
+    renderScalar( m_mode, segs, runs, numRuns, numSegs, m_position, m_noise.data(), buffer, samples );
+}
+
+// ---------------------------------------------------------------------------
+//  setInstructionSet
+// ---------------------------------------------------------------------------
+//  Use another instruction set. Instruction sets not supported by
+//  this CPU are replaced by the best supported one.
+//
+void
+RealtimeOscillatorBank::setInstructionSet( InstructionSet set ) noexcept
+{
+    m_instructionSet = std::min( set, detectInstructionSet() );
+}
+
+// ---------------------------------------------------------------------------
+//  detectInstructionSet
+// ---------------------------------------------------------------------------
+//  Return the best instruction set supported by this CPU.
+//
+RealtimeOscillatorBank::InstructionSet
+RealtimeOscillatorBank::detectInstructionSet( void ) noexcept
+{
+#if LORIS_OSCILLATOR_BANK_LANES
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx512f" ) )
+        return AVX512;
+    if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) )
+        return AVX2;
+    if ( __builtin_cpu_supports( "sse2" ) )
+        return SSE2;
+#endif
+    return Scalar;
+}
+
+}   //  end of namespace Loris
@@ -0,0 +1,216 @@
+#ifndef INCLUDE_REALTIME_OSCILLATOR_BANK_H
+#define INCLUDE_REALTIME_OSCILLATOR_BANK_H
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimeOscillatorBank.h
+ *
+ * Definition of class Loris::RealtimeOscillatorBank, renders many
+ * sinusoidal Partials at once, one Partial per SIMD lane.
+ *
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+// from juce_PlatformDefs.h
+#ifdef _MSC_VER
+	#ifdef noexcept
+		#undef noexcept
+	#endif
+	#define noexcept  throw()
+	#if defined (_MSC_VER) && _MSC_VER > 1600
+		#define _ALLOW_KEYWORD_MACROS 1 // (to stop VC2012 complaining)
+	#endif
+#endif
+
+//  begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//  class RealtimeOscillatorBank
+//
+//! A RealtimeOscillatorBank renders one block of samples of many
+//! sinusoidal Partials in lockstep, each Partial in its own SIMD lane.
+//!
+//! For every block the synthesizer first collects segments - spans of
+//! samples with linear frequency and amplitude trajectories - grouped
+//! into runs, one run per Partial. render() then processes 4, 8 or 16
+//! runs at once (SSE2, AVX2 or AVX-512, chosen at run time from the CPU
+//! features) and mixes them into the sample buffer.
+//!
+//! The phase of every segment is given by the caller, so the float phase
+//! accumulated in the lanes never drifts longer than one segment.
+//!
+//! In Cosine mode every sample evaluates a cosine of the accumulated
+//! phase. In Rotator mode a complex phasor is multiplied by a rotator
+//! (itself rotated to follow the frequency glide), which takes only a
+//! few multiply-adds per sample.
+//!
+//! Partials with non-zero bandwidth are bandwidth-enhanced the same way
+//! as by Oscillator: the sinusoid is amplitude modulated by lowpass
+//! filtered Gaussian noise. The noise of a block is generated for all
+//! lanes at once from a counter-based random number generator keyed by
+//! the Partial, so it does not depend on the block size and needs no
+//! state except the filter.
+//
+class RealtimeOscillatorBank
+{
+//  --- interface ---
+public:
+    //! Instruction sets render() can use.
+    enum InstructionSet { Scalar = 0, SSE2, AVX2, AVX512 };
+
+    //! Oscillator algorithms.
+    enum Mode { Cosine = 0, Rotator };
+
+    //! Segment of a run, frequency in radians per sample.
+    struct Segment
+    {
+        int offset, end;
+        float phase, frequency, dFrequency, amplitude, dAmplitude;
+        float bandwidth, dBandwidth;
+    };
+
+    //! Bandwidth-enhancement noise of one Partial, kept by the caller
+    //! for the whole life of the Partial.
+    struct Noise
+    {
+        uint32_t key = 0;           //! selects the random sequence
+        float filter[3] = {};       //! lowpass filter delay line
+
+        //! Clear the filter, done when the Partial starts.
+        void reset( void ) { filter[0] = filter[1] = filter[2] = 0.f; }
+    };
+
+    //! Run of segments of one Partial.
+    struct Run
+    {
+        int first;          //! index of the first segment
+        Noise * noise;      //! noise of the Partial, may be 0
+        bool noisy;         //! true if any segment has bandwidth
+
+        Run( int first, Noise * noise ) : first( first ), noise( noise ), noisy( false ) {}
+    };
+
+//  --- construction ---
+
+    //! Construct an empty bank in Rotator mode using the best
+    //! instruction set supported by this CPU.
+    RealtimeOscillatorBank( void );
+
+    //  Copy, assignment, and destruction are free.
+
+    //! Preallocate memory for blocks of up to maxSamples samples and
+    //! up to numSegments segments (see RealtimePartialBank::maxSegments()),
+    //! neither collecting segments nor rendering allocates.
+    void prepare( int maxSamples, int numSegments );
+
+// --- segments ---
+
+    //! Forget all segments, start collecting a new block.
+    //!
+    //! \param  position    Index of the first sample of the block since the
+    //!                     sound started, the counter of the noise generator.
+    void clear( uint32_t position = 0 ) noexcept { m_runs.clear(); m_segments.clear(); m_position = position; }
+
+    //! Start a new run, following segments belong to the same Partial
+    //! and must not overlap.
+    //!
+    //! \param  noise   Noise of the Partial, or 0 to ignore bandwidth.
+    void beginPartial( Noise * noise = 0 )
+    {
+        assert( m_runs.size() < m_runs.capacity() );
+        m_runs.push_back( Run( (int) m_segments.size(), noise ) );
+    }
+
+    //! Add a segment to the current run.
+    //!
+    //! \param  offset      First sample of the segment in the block.
+    //! \param  length      Number of samples, has to be positive.
+    //! \param  phase       Phase at the first sample in radians.
+    //! \param  frequency   Frequency at the first sample in radians per sample.
+    //! \param  dFrequency  Frequency increment per sample.
+    //! \param  amplitude   Amplitude at the first sample.
+    //! \param  dAmplitude  Amplitude increment per sample.
+    //! \param  bandwidth   Bandwidth coefficient at the first sample.
+    //! \param  dBandwidth  Bandwidth increment per sample.
+    void addSegment( int offset, int length, double phase,
+                     double frequency, double dFrequency,
+                     double amplitude, double dAmplitude,
+                     double bandwidth = 0., double dBandwidth = 0. );
+
+    //! Return number of collected segments.
+    int numSegments( void ) const noexcept { return (int) m_segments.size(); }
+
+    //! Return the collected segments of all runs.
+    const std::vector< Segment > & segments( void ) const noexcept { return m_segments; }
+
+// --- rendering ---
+
+    //! Accumulate all collected segments into buffer.
+    //!
+    //! \param  buffer  The samples buffer, results are added to it.
+    //! \param  samples Number of samples in the block.
+    //! \pre    No segment ends after samples, samples is at most the
+    //!         maxSamples given to prepare().
+    void render( float * buffer, int samples ) noexcept;
+
+// --- mode ---
+
+    //! Return the oscillator algorithm.
+    Mode mode( void ) const noexcept { return m_mode; }
+
+    //! Set the oscillator algorithm.
+    void setMode( Mode mode ) noexcept { m_mode = mode; }
+
+// --- instruction set ---
+
+    //! Return the instruction set used by render().
+    InstructionSet instructionSet( void ) const noexcept { return m_instructionSet; }
+
+    //! Use another instruction set. Instruction sets not supported by
+    //! this CPU are replaced by the best supported one.
+    void setInstructionSet( InstructionSet set ) noexcept;
+
+    //! Return the best instruction set supported by this CPU.
+    static InstructionSet detectInstructionSet( void ) noexcept;
+
+    //! Return number of Partials rendered at once by the instruction set.
+    int lanes( void ) const noexcept { return m_instructionSet == AVX512 ? 16 : m_instructionSet == AVX2 ? 8 : m_instructionSet == SSE2 ? 4 : 1; }
+
+//  --- implementation ---
+private:
+    std::vector< Segment > m_segments;  //  segments of all runs
+    std::vector< Run > m_runs;          //  runs of all Partials
+    std::vector< float > m_scratch;     //  per lane accumulator of a block
+    std::vector< float > m_noise;       //  per lane noise of a block
+    uint32_t m_position;                //  noise counter of the first sample
+    InstructionSet m_instructionSet;
+    Mode m_mode;
+
+};  //  end of class RealtimeOscillatorBank
+
+}   //  end of namespace Loris
+
+#endif /* ndef INCLUDE_REALTIME_OSCILLATOR_BANK_H */
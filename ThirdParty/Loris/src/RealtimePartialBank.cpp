@@ -0,0 +1,323 @@
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimePartialBank.C
+ *
+ * Implementation of class Loris::RealtimePartialBank, read-only Partial data
+ * shared by all RealTimeSynthesizers playing the same sound.
+ *
+ */
+#if HAVE_CONFIG_H
+    #include "config.h"
+#endif
+#include "RealtimePartialBank.h"
+#include "BreakpointUtils.h"
+#include "Partial.h"
+#include "RealtimeSynthesizer.h"  //  Pi
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+//  begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//  Storage
+// ---------------------------------------------------------------------------
+//  Arrays of a bank compiled from Partials, the views of the bank point
+//  into them.
+struct RealtimePartialBank::Storage
+{
+    std::vector< PartialStruct > partials;
+    std::vector< int > startOrder;
+    std::vector< int > loudnessOrder;
+
+    std::vector< int > sample;
+    std::vector< float > frequency;
+    std::vector< float > amplitude;
+    std::vector< float > bandwidth;
+    std::vector< float > phase;
+    std::vector< float > frequencyIncrement;
+    std::vector< float > amplitudeIncrement;
+    std::vector< float > bandwidthIncrement;
+
+    void reserveBreakpoints( std::size_t n )
+    {
+        sample.reserve( n );
+        frequency.reserve( n );
+        amplitude.reserve( n );
+        bandwidth.reserve( n );
+        phase.reserve( n );
+        frequencyIncrement.reserve( n );
+        amplitudeIncrement.reserve( n );
+        bandwidthIncrement.reserve( n );
+    }
+};
+
+//  view of a whole vector
+template< typename T >
+static BankArray< T > view( const std::vector< T > & v )
+{
+    return BankArray< T >( v.data(), v.size() );
+}
+
+// ---------------------------------------------------------------------------
+//  RealtimePartialBank constructor
+// ---------------------------------------------------------------------------
+//!	Compile the bank from Partials. Partials with no Breakpoints are skipped.
+//! Partials with start times earlier than the fade time will have shorter
+//! onset fades.
+//!
+//! \param  partials The Partials to synthesize, in any order.
+//! \param  fadeTime The Partial fade time in seconds.
+//! \param  sampleRate The sample rate in Hz the bank is compiled for.
+//! \param  availableTime The time in seconds up to which the Partials
+//!         are complete, negative if they are complete.
+RealtimePartialBank::RealtimePartialBank( const PartialList & partials, double fadeTime, double sampleRate,
+                                          double availableTime ) :
+    m_fadeTimeSec( fadeTime ),
+    m_srateHz( sampleRate ),
+    m_maxActivePartials( 0 ),
+    m_noiseEnergy( 0 ),
+    m_availableSamples( std::numeric_limits< int >::max() )
+{
+    //  Partials being analyzed end at availableTime, never play their fade out
+    if ( availableTime >= 0. )
+    {
+        m_availableSamples = std::max( int( ( availableTime - fadeTime ) * sampleRate ), 0 );
+    }
+
+    std::shared_ptr< Storage > storage( new Storage );
+    Storage & s = *storage;
+
+    std::size_t numBreakpoints = 0;
+    for (const Partial & it : partials)
+        numBreakpoints += it.numBreakpoints() + 2;
+
+    s.partials.reserve( partials.size() );
+    s.reserveBreakpoints( numBreakpoints );
+
+    // partials keep their order, startOrder() sorts them by time
+    for (const Partial & it : partials)
+    {
+        if (it.numBreakpoints() <= 0) continue;
+
+        PartialStruct pStruct;
+
+        pStruct.numBreakpoints = it.numBreakpoints() + 2;// + fade in + fade out
+        pStruct.firstBreakpoint = (int) s.sample.size();
+        pStruct.label = it.label();
+
+        pStruct.startTime = ( m_fadeTimeSec < it.startTime() ) ? ( it.startTime() - m_fadeTimeSec ) : 0.;// compute fade in bp time
+        pStruct.endTime = it.endTime() + m_fadeTimeSec;// compute fade out bp time
+
+        // breakpoints
+        Partial::const_iterator jt = it.begin();
+        // fade in breakpoint, compute fade in time
+        append( s, pStruct.startTime, BreakpointUtils::makeNullBefore( jt.breakpoint(), it.startTime() - pStruct.startTime ), true, m_srateHz );
+
+        double sumF = 0;
+
+        for (; jt != it.end(); jt++)
+        {
+            sumF += jt->frequency();
+            append( s, jt.time(), jt.breakpoint(), false, m_srateHz );
+        }
+
+        pStruct.avgFrequency = 2 * Pi * sumF / ( it.numBreakpoints() * m_srateHz );
+        pStruct.minFrequency = *std::min_element( s.frequency.begin() + pStruct.firstBreakpoint, s.frequency.end() );
+        pStruct.peakAmplitude = *std::max_element( s.amplitude.begin() + pStruct.firstBreakpoint, s.amplitude.end() );
+
+        // fade out breakpoint
+        jt--;
+        append( s, jt.time() + m_fadeTimeSec, BreakpointUtils::makeNullAfter( jt.breakpoint(), m_fadeTimeSec ), false, m_srateHz );
+
+        pStruct.startSample = s.sample[pStruct.firstBreakpoint];
+        pStruct.endSample = s.sample.back();
+
+        s.partials.push_back( pStruct );
+    }
+
+    //  admission order, the Partials are usually sorted already
+    s.startOrder.resize( s.partials.size() );
+    for (std::size_t i = 0; i < s.partials.size(); ++i)
+        s.startOrder[i] = (int) i;
+    std::stable_sort( s.startOrder.begin(), s.startOrder.end(),
+                      [&s]( int a, int b ) { return s.partials[a].startSample < s.partials[b].startSample; } );
+
+    //  level of detail order, ties keep the Partial order
+    s.loudnessOrder.resize( s.partials.size() );
+    for (std::size_t i = 0; i < s.partials.size(); ++i)
+        s.loudnessOrder[i] = (int) i;
+    std::stable_sort( s.loudnessOrder.begin(), s.loudnessOrder.end(),
+                      [&s]( int a, int b ) { return s.partials[a].peakAmplitude > s.partials[b].peakAmplitude; } );
+    for (std::size_t i = 0; i < s.loudnessOrder.size(); ++i)
+        s.partials[s.loudnessOrder[i]].loudnessRank = (int) i;
+
+    //  count Partials sounding at once, ends sort before starts at the same sample
+    std::vector< std::pair< int, int > > events;
+    events.reserve( 2 * s.partials.size() );
+    for (const PartialStruct & p : s.partials)
+    {
+        events.push_back( std::make_pair( p.startSample, 1 ) );
+        events.push_back( std::make_pair( p.endSample, -1 ) );
+    }
+    std::sort( events.begin(), events.end() );
+
+    int active = 0;
+    for (const std::pair< int, int > & e : events)
+    {
+        active += e.second;
+        m_maxActivePartials = std::max( m_maxActivePartials, active );
+    }
+
+    //  a bandwidth-enhanced Breakpoint carries amplitude^2 * bandwidth
+    //  of its energy as noise
+    double energy = 0, noise = 0;
+    for (std::size_t i = 0; i < s.amplitude.size(); ++i)
+    {
+        double e = (double) s.amplitude[i] * s.amplitude[i];
+        energy += e;
+        noise += e * s.bandwidth[i];
+    }
+    if ( energy > 0 )
+        m_noiseEnergy = float( noise / energy );
+
+    m_partials = view( s.partials );
+    m_startOrder = view( s.startOrder );
+    m_loudnessOrder = view( s.loudnessOrder );
+    m_breakpoints.sample = view( s.sample );
+    m_breakpoints.frequency = view( s.frequency );
+    m_breakpoints.amplitude = view( s.amplitude );
+    m_breakpoints.bandwidth = view( s.bandwidth );
+    m_breakpoints.phase = view( s.phase );
+    m_breakpoints.frequencyIncrement = view( s.frequencyIncrement );
+    m_breakpoints.amplitudeIncrement = view( s.amplitudeIncrement );
+    m_breakpoints.bandwidthIncrement = view( s.bandwidthIncrement );
+    m_storage = storage;
+}
+
+// ---------------------------------------------------------------------------
+//  RealtimePartialBank constructor
+// ---------------------------------------------------------------------------
+//! Construct an empty bank, RealtimeBankFile sets the arrays.
+RealtimePartialBank::RealtimePartialBank( double fadeTime, double sampleRate, int maxActivePartials,
+                                          float noiseEnergy ) :
+    m_fadeTimeSec( fadeTime ),
+    m_srateHz( sampleRate ),
+    m_maxActivePartials( maxActivePartials ),
+    m_noiseEnergy( noiseEnergy ),
+    m_availableSamples( std::numeric_limits< int >::max() )
+{
+}
+
+// ---------------------------------------------------------------------------
+//  append
+// ---------------------------------------------------------------------------
+//! Append one Breakpoint of a Partial. Time is converted to sample index,
+//! frequency to radians per sample, bandwidth is clamped to [0, 1] and
+//! the increments of the segment ending at this Breakpoint are computed.
+void RealtimePartialBank::append( Storage & s, double time, const Breakpoint & bp, bool first, double sampleRate )
+{
+    int samp = int( (time * sampleRate) + 0.5 );   //  cheap rounding
+    double freq = bp.frequency() * 2 * Pi / sampleRate;
+    double bw = std::min( std::max( bp.bandwidth(), 0. ), 1. );
+
+    float dFreq = 0, dAmp = 0, dBw = 0;
+    if ( !first )
+    {
+        int length = samp - s.sample.back();
+        if ( length > 0 )
+        {
+            dFreq = ( freq - s.frequency.back() ) / length;
+            dAmp = ( bp.amplitude() - s.amplitude.back() ) / length;
+            dBw = ( bw - s.bandwidth.back() ) / length;
+        }
+    }
+
+    s.sample.push_back( samp );
+    s.frequency.push_back( freq );
+    s.amplitude.push_back( bp.amplitude() );
+    s.bandwidth.push_back( bw );
+    s.phase.push_back( bp.phase() );
+    s.frequencyIncrement.push_back( dFreq );
+    s.amplitudeIncrement.push_back( dAmp );
+    s.bandwidthIncrement.push_back( dBw );
+}
+
+// ---------------------------------------------------------------------------
+//  maxSegments
+// ---------------------------------------------------------------------------
+//! Return the largest number of segments a synthesizer can plan in one
+//! block. A block holds one segment more of a Partial than it holds
+//! Breakpoints of it, the segments of all Partials planned in the same
+//! block are summed.
+//!
+//! \param  samples The longest block planned at once.
+int RealtimePartialBank::maxSegments( int samples ) const
+{
+    const int * bpSample = m_breakpoints.sample.data();
+
+    //  a Partial is planned in blocks starting from samples before
+    //  its start to its end, ends sort before starts at the same sample
+    std::vector< std::pair< int, int > > events;
+    events.reserve( 2 * m_partials.size() );
+    for (const PartialStruct & p : m_partials)
+    {
+        const int * sample = bpSample + p.firstBreakpoint;
+        int most = 0;
+        for (int i = 0, j = 0; j < p.numBreakpoints; ++j)
+        {
+            while ( sample[j] - sample[i] >= samples )
+                ++i;
+            most = std::max( most, j - i + 1 );
+        }
+
+        int segments = std::min( most + 1, p.numBreakpoints - 1 );
+        events.push_back( std::make_pair( p.startSample - samples, segments ) );
+        events.push_back( std::make_pair( p.endSample + 1, -segments ) );
+    }
+    std::sort( events.begin(), events.end() );
+
+    int planned = 0, most = 0;
+    for (const std::pair< int, int > & e : events)
+    {
+        planned += e.second;
+        most = std::max( most, planned );
+    }
+    return most;
+}
+
+// ---------------------------------------------------------------------------
+//  create
+// ---------------------------------------------------------------------------
+//! Build a bank and return it ready to be shared.
+RealtimePartialBank::Ptr
+RealtimePartialBank::create( const PartialList & partials, double fadeTime, double sampleRate,
+                             double availableTime )
+{
+    return Ptr( new RealtimePartialBank( partials, fadeTime, sampleRate, availableTime ) );
+}
+
+}   //  end of namespace Loris
@@ -0,0 +1,235 @@
+#ifndef INCLUDE_REALTIME_PARTIAL_BANK_H
+#define INCLUDE_REALTIME_PARTIAL_BANK_H
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimePartialBank.h
+ *
+ * Definition of class Loris::RealtimePartialBank, read-only Partial data
+ * shared by all RealTimeSynthesizers playing the same sound.
+ *
+ */
+
+#include "Breakpoint.h"
+#include "PartialList.h"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+//	begin namespace
+namespace Loris {
+
+// Header of one Partial in a RealtimePartialBank. Breakpoints of all Partials
+// are stored one after another in RealtimePartialBank::BreakpointArrays, this
+// Partial owns numBreakpoints of them starting at firstBreakpoint. It holds
+// no synthesis state, so one instance can be read by any number of
+// synthesizers at once.
+struct PartialStruct
+{
+    enum { NoBreakpointProcessed = 0, FirstBreakpoint };
+
+    double startTime = 0.0;
+    double endTime = 0.0;
+    int startSample = 0;        // sample index of the fade in Breakpoint
+    int endSample = 0;          // sample index of the fade out Breakpoint
+    int firstBreakpoint = 0;    // index of the fade in Breakpoint in BreakpointArrays
+    int numBreakpoints = 0;
+    int label = 0;
+    float avgFrequency = 0;     // radians per sample
+    float minFrequency = 0;     // radians per sample, lowest of all Breakpoints
+    float peakAmplitude = 0;    // highest amplitude of all Breakpoints
+    int loudnessRank = 0;       // 0 for the Partial with the highest peak amplitude
+};
+
+// ---------------------------------------------------------------------------
+//	class BankArray
+//
+//! Read-only view of one array of a RealtimePartialBank. The elements are
+//! owned by the bank, either in its own memory or in a mapped bank file
+//! (see RealtimeBankFile).
+//
+template< typename T >
+class BankArray
+{
+public:
+    BankArray( void ) : m_data( 0 ), m_size( 0 ) {}
+    BankArray( const T * data, std::size_t size ) : m_data( data ), m_size( size ) {}
+
+    const T * data( void ) const { return m_data; }
+    std::size_t size( void ) const { return m_size; }
+    bool empty( void ) const { return m_size == 0; }
+
+    const T & operator[]( std::size_t i ) const { return m_data[i]; }
+    const T * begin( void ) const { return m_data; }
+    const T * end( void ) const { return m_data + m_size; }
+
+private:
+    const T * m_data;
+    std::size_t m_size;
+};
+
+// ---------------------------------------------------------------------------
+//	class RealtimePartialBank
+//
+//! A RealtimePartialBank is an immutable collection of Partials compiled
+//! once from a PartialList into a render plan for a given sample rate.
+//! Fade in/out null Breakpoints are inserted at either end of every Partial.
+//!
+//! Breakpoints are stored as structure of arrays. Times are converted to
+//! target sample indices, frequencies to radians per sample (at frequency
+//! scaling 1) and per-sample frequency, amplitude and bandwidth increments
+//! of each segment are precomputed, so the synthesizer only streams through memory.
+//!
+//! The bank is shared (reference counted) by all synthesizers playing
+//! the same sound, each of them keeps only its own small playback state
+//! per Partial. Use RealtimePartialBank::Ptr to hold it.
+//!
+//! RealtimeBankFile stores the arrays of a bank in a file and maps them
+//! back into memory, a mapped bank is used in place.
+//
+class RealtimePartialBank
+{
+//	-- public interface --
+public:
+    typedef std::shared_ptr< const RealtimePartialBank > Ptr;
+
+    //! Breakpoints of all Partials. Element i of the increment arrays
+    //! describes the segment ending at Breakpoint i, it is 0 for the
+    //! first Breakpoint of every Partial.
+    struct BreakpointArrays
+    {
+        BankArray< int > sample;                    //! target sample index
+        BankArray< float > frequency;               //! radians per sample
+        BankArray< float > amplitude;               //! absolute amplitude
+        BankArray< float > bandwidth;               //! bandwidth coefficient, 0 to 1
+        BankArray< float > phase;                   //! radians
+        BankArray< float > frequencyIncrement;      //! radians per sample per sample
+        BankArray< float > amplitudeIncrement;      //! amplitude per sample
+        BankArray< float > bandwidthIncrement;      //! bandwidth per sample
+
+        std::size_t size( void ) const { return sample.size(); }
+    };
+
+//	-- construction --
+    //!	Compile the bank from Partials. Partials with no Breakpoints are skipped.
+    //! Partials with start times earlier than the fade time will have shorter
+    //! onset fades.
+    //!
+    //! Partials of a sound still being analyzed are complete only up to
+    //! availableTime, synthesizers wait there until they are given a bank
+    //! extending this one (see RealTimeSynthesizer::continueFrom()).
+    //!
+    //! \param  partials The Partials to synthesize, in any order.
+    //! \param  fadeTime The Partial fade time in seconds.
+    //! \param  sampleRate The sample rate in Hz the bank is compiled for.
+    //! \param  availableTime The time in seconds up to which the Partials
+    //!         are complete, negative if they are complete.
+    RealtimePartialBank( const PartialList & partials, double fadeTime, double sampleRate,
+                         double availableTime = -1. );
+
+    //! Build a bank and return it ready to be shared.
+    static Ptr create( const PartialList & partials, double fadeTime, double sampleRate,
+                       double availableTime = -1. );
+
+//	-- access --
+    //! Return the Partials of this bank.
+    const BankArray< PartialStruct > & partials( void ) const { return m_partials; }
+
+    //! Return the Breakpoints of all Partials of this bank.
+    const BreakpointArrays & breakpoints( void ) const { return m_breakpoints; }
+
+    //! Return number of Partials in this bank.
+    int size( void ) const { return (int) m_partials.size(); }
+
+    //! Return true if there are no Partials in this bank.
+    bool empty( void ) const { return m_partials.empty(); }
+
+    //! Return the largest number of Partials sounding at the same time.
+    int maxActivePartials( void ) const { return m_maxActivePartials; }
+
+    //! Return the fraction of the energy of all Breakpoints carried by
+    //! bandwidth-enhancement noise, 0 for pure sinusoids.
+    float noiseEnergy( void ) const { return m_noiseEnergy; }
+
+    //! Return the largest number of segments a synthesizer can plan in
+    //! one block, see RealtimeOscillatorBank::prepare(). It scans all
+    //! Breakpoints, call it once per setup.
+    //!
+    //! \param  samples The longest block planned at once.
+    int maxSegments( int samples ) const;
+
+    //! Return indices of the Partials sorted by start sample, the order
+    //! in which synthesizers admit them.
+    const BankArray< int > & startOrder( void ) const { return m_startOrder; }
+
+    //! Return indices of the Partials sorted by peak amplitude, the
+    //! loudest first. PartialStruct::loudnessRank is the position of a
+    //! Partial in this order.
+    const BankArray< int > & loudnessOrder( void ) const { return m_loudnessOrder; }
+
+    //! Return the fade time used to build this bank.
+    double fadeTime( void ) const { return m_fadeTimeSec; }
+
+    //! Return the sample rate this bank is compiled for.
+    double sampleRate( void ) const { return m_srateHz; }
+
+    //! Return the number of samples that can be synthesized, the largest
+    //! int if the Partials are complete.
+    int availableSamples( void ) const { return m_availableSamples; }
+
+    //! Return true if the Partials are complete.
+    bool isComplete( void ) const { return m_availableSamples == std::numeric_limits< int >::max(); }
+
+//	-- implementation --
+private:
+    friend class RealtimeBankFile;
+
+    //  arrays of a bank compiled from Partials
+    struct Storage;
+
+    //! Construct an empty bank, RealtimeBankFile sets the arrays.
+    RealtimePartialBank( double fadeTime, double sampleRate, int maxActivePartials, float noiseEnergy );
+
+    //! Append one Breakpoint of a Partial.
+    static void append( Storage & storage, double time, const Breakpoint & bp, bool first, double sampleRate );
+
+    BankArray< PartialStruct > m_partials;
+    BreakpointArrays m_breakpoints;
+    BankArray< int > m_startOrder;
+    BankArray< int > m_loudnessOrder;
+    double m_fadeTimeSec;
+    double m_srateHz;
+    int m_maxActivePartials;
+    float m_noiseEnergy;                        //  noise share of the Breakpoint energy
+    int m_availableSamples;                     //  Partials are complete up to this sample
+    std::shared_ptr< const void > m_storage;    //  owns the arrays, Storage or a mapped file
+
+    //  not copyable, it is meant to be shared
+    RealtimePartialBank( const RealtimePartialBank & );
+    RealtimePartialBank & operator= ( const RealtimePartialBank & );
+
+};	//	end of class RealtimePartialBank
+
+}	//	end of namespace Loris
+
+#endif /* ndef INCLUDE_REALTIME_PARTIAL_BANK_H */
@@ -0,0 +1,208 @@
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimeSpectralBank.C
+ *
+ * Implementation of class Loris::RealtimeSpectralBank, renders sinusoidal
+ * Partials by inverse Fourier transform and overlap-add.
+ *
+ */
+#if HAVE_CONFIG_H
+    #include "config.h"
+#endif
+#include "RealtimeSpectralBank.h"
+#include "RealtimeSynthesizer.h"  //  Pi
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+//  begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//  blackmanHarris
+// ---------------------------------------------------------------------------
+//  4-term Blackman-Harris window, 92 dB sidelobes, main lobe 8 bins wide.
+//  Zero-phase: m is relative to the window center.
+//
+static double blackmanHarris( int m, int N )
+{
+    double x = 2 * Pi * ( m + 0.5 * N ) / N;
+    return 0.35875 - 0.48829 * std::cos( x ) + 0.14128 * std::cos( 2 * x ) - 0.01168 * std::cos( 3 * x );
+}
+
+// ---------------------------------------------------------------------------
+//  RealtimeSpectralBank constructor
+// ---------------------------------------------------------------------------
+//  Construct a new bank, ready to render from sample 0. The window
+//  transform and the synthesis window are tabulated here.
+//
+RealtimeSpectralBank::RealtimeSpectralBank( void ) :
+    m_fft( FrameSize ),
+    m_kernel( KernelHalfWidth * KernelOversampling + 2, 0. ),
+    m_synthesisWindow( 2 * HopSize, 0. ),
+    m_overlapAdd( 2 * HopSize, 0.f )
+{
+    //  W(d) = sum w(m) cos(2 Pi d m / N), real because w is symmetric
+    for ( int j = 0; j <= KernelHalfWidth * KernelOversampling; ++j )
+    {
+        double d = double( j ) / KernelOversampling;
+        double sum = 0.;
+        for ( int m = -FrameSize / 2; m < FrameSize / 2; ++m )
+            sum += blackmanHarris( m, FrameSize ) * std::cos( 2 * Pi * d * m / FrameSize );
+        m_kernel[j] = sum / FrameSize;
+    }
+
+    //  triangles with hop HopSize sum to one
+    for ( int m = -HopSize + 1; m < HopSize; ++m )
+        m_synthesisWindow[m + HopSize] = ( 1. - std::abs( m ) / double( HopSize ) ) / blackmanHarris( m, FrameSize );
+
+    reset();
+}
+
+// ---------------------------------------------------------------------------
+//  prepare
+// ---------------------------------------------------------------------------
+//  Preallocate memory for blocks of up to maxSamples samples, frames
+//  reach HopSize samples to both sides of the center.
+//
+void
+RealtimeSpectralBank::prepare( int maxSamples )
+{
+    m_overlapAdd.assign( maxSamples + 2 * HopSize, 0.f );
+    reset();
+}
+
+// ---------------------------------------------------------------------------
+//  reset
+// ---------------------------------------------------------------------------
+//  Forget all rendered frames, the next block starts at sample 0.
+//
+void
+RealtimeSpectralBank::reset( void ) noexcept
+{
+    std::fill( m_overlapAdd.begin(), m_overlapAdd.end(), 0.f );
+    m_overlapAddStart = 0;
+    m_nextCenter = 0;
+}
+
+// ---------------------------------------------------------------------------
+//  continueFrom
+// ---------------------------------------------------------------------------
+//  Continue rendering where another bank is, taking the frames it has
+//  rendered but not output yet. The frames reach at most latency() plus
+//  HopSize samples ahead, both overlap-add buffers hold them.
+//
+void
+RealtimeSpectralBank::continueFrom( const RealtimeSpectralBank & other ) noexcept
+{
+    std::copy( other.m_overlapAdd.begin(), other.m_overlapAdd.begin() + 2 * HopSize, m_overlapAdd.begin() );
+    std::fill( m_overlapAdd.begin() + 2 * HopSize, m_overlapAdd.end(), 0.f );
+    m_overlapAddStart = other.m_overlapAddStart;
+    m_nextCenter = other.m_nextCenter;
+}
+
+// ---------------------------------------------------------------------------
+//  render
+// ---------------------------------------------------------------------------
+//  Render frames centered in the planned range and accumulate the
+//  next block of samples into buffer.
+//
+void
+RealtimeSpectralBank::render( const RealtimeOscillatorBank & plan, int planStart, int planSamples,
+                              float * buffer, int samples ) noexcept
+{
+    //  sized by prepare(), never on the audio thread
+    assert( (int) m_overlapAdd.size() >= samples + 2 * HopSize );
+
+    for ( ; m_nextCenter < planStart + planSamples; m_nextCenter += HopSize )
+    {
+        if ( m_nextCenter >= planStart && plan.numSegments() > 0 )
+            renderFrame( plan, planStart, m_nextCenter );
+    }
+
+    for ( int i = 0; i < samples; ++i )
+        buffer[i] += m_overlapAdd[i];
+
+    //  frames end before the planned samples plus HopSize, only the
+    //  samples after the block up to there are not zero
+    std::copy( m_overlapAdd.begin() + samples, m_overlapAdd.begin() + samples + 2 * HopSize, m_overlapAdd.begin() );
+    std::fill( m_overlapAdd.begin() + 2 * HopSize, m_overlapAdd.begin() + samples + 2 * HopSize, 0.f );
+    m_overlapAddStart += samples;
+}
+
+// ---------------------------------------------------------------------------
+//  renderFrame
+// ---------------------------------------------------------------------------
+//  Add the frame centered at absolute sample center to the overlap-add
+//  buffer. The inverse transform is computed by the forward transform of
+//  the complex conjugate spectrum, only the real part is used.
+//
+void
+RealtimeSpectralBank::renderFrame( const RealtimeOscillatorBank & plan, int planStart, int center ) noexcept
+{
+    typedef RealtimeOscillatorBank::Segment Segment;
+
+    std::fill( m_fft.begin(), m_fft.end(), std::complex< double >( 0., 0. ) );
+
+    const double binsPerRadian = FrameSize / ( 2 * Pi );
+    const std::vector< Segment > & segs = plan.segments();
+    for ( const Segment & s : segs )
+    {
+        int k = center - planStart - s.offset;
+        if ( k < 0 || center - planStart >= s.end )
+            continue;
+
+        //  the same trajectory the oscillators follow
+        double f = s.frequency + k * (double) s.dFrequency;
+        double a = s.amplitude + k * (double) s.dAmplitude;
+        if ( f <= 0. || f >= Pi || a <= 0. )
+            continue;
+        double ph = s.phase + k * ( s.frequency + 0.5 * s.dFrequency * k );
+
+        std::complex< double > c = std::polar( a, -ph );
+        double bin = f * binsPerRadian;
+        int first = (int) std::ceil( bin - KernelHalfWidth );
+        int last = (int) std::floor( bin + KernelHalfWidth );
+        for ( int j = first; j <= last; ++j )
+        {
+            //  linear interpolation in the kernel table
+            double d = std::abs( j - bin ) * KernelOversampling;
+            int i = (int) d;
+            double w = m_kernel[i] + ( d - i ) * ( m_kernel[i + 1] - m_kernel[i] );
+            m_fft[ j & ( FrameSize - 1 ) ] += w * c;
+        }
+    }
+
+    m_fft.transform();
+
+    int first = std::max( -HopSize + 1, m_overlapAddStart - center );
+    for ( int m = first; m < HopSize; ++m )
+    {
+        m_overlapAdd[center + m - m_overlapAddStart] +=
+            m_fft[ m & ( FrameSize - 1 ) ].real() * m_synthesisWindow[m + HopSize];
+    }
+}
+
+}   //  end of namespace Loris
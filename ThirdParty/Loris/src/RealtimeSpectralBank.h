@@ -0,0 +1,127 @@
+#ifndef INCLUDE_REALTIME_SPECTRAL_BANK_H
+#define INCLUDE_REALTIME_SPECTRAL_BANK_H
+/*
+ * This is the Loris C++ Class Library, implementing analysis,
+ * manipulation, and synthesis of digitized sounds using the Reassigned
+ * Bandwidth-Enhanced Additive Sound Model.
+ *
+ * Loris is Copyright (c) 1999-2010, 2014 by Kelly Fitz, Lippold Haken and Tomas Medek
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * RealtimeSpectralBank.h
+ *
+ * Definition of class Loris::RealtimeSpectralBank, renders sinusoidal
+ * Partials by inverse Fourier transform and overlap-add.
+ *
+ */
+
+#include "FourierTransform.h"
+#include "RealtimeOscillatorBank.h"
+
+#include <assert.h>
+#include <vector>
+
+//  begin namespace
+namespace Loris {
+
+// ---------------------------------------------------------------------------
+//  class RealtimeSpectralBank
+//
+//! A RealtimeSpectralBank renders the segments collected in a
+//! RealtimeOscillatorBank using the inverse FFT method of Rodet and
+//! Depalle. Once per hop the frequency, amplitude and phase of every
+//! Partial at the frame center are evaluated, the transform of a
+//! Blackman-Harris window is added into a spectrum at the Partial
+//! frequency (only the main lobe, 8 bins), the spectrum is inverse
+//! transformed and overlap-added with a triangular synthesis window.
+//!
+//! The cost per sample is nearly independent of the number of
+//! Partials, so it pays off for dense Partial sets. Frames are
+//! stationary, so fast transitions are smoothed over a hop.
+//!
+//! A frame centered at sample t contributes to samples up to t + hop,
+//! so the segments have to be planned latency() samples ahead of the
+//! rendered samples. There is no latency in the output.
+//
+class RealtimeSpectralBank
+{
+//  --- interface ---
+public:
+    enum
+    {
+        FrameSize = 1024,                   //! inverse transform length
+        HopSize = FrameSize / 4,            //! half length of the synthesis window
+        KernelHalfWidth = 4,                //! main lobe half width in bins
+        KernelOversampling = 64             //! kernel table points per bin
+    };
+
+//  --- construction ---
+
+    //! Construct a new bank, ready to render from sample 0 once it is
+    //! prepared.
+    RealtimeSpectralBank( void );
+
+    //  Copy, assignment, and destruction are free.
+
+    //! Preallocate memory for blocks of up to maxSamples samples, so
+    //! that rendering does not allocate. The bank is reset.
+    void prepare( int maxSamples );
+
+    //! Forget all rendered frames, the next block starts at sample 0.
+    void reset( void ) noexcept;
+
+    //! Continue rendering where another bank is, taking the frames it
+    //! has rendered but not output yet. It does not allocate.
+    void continueFrom( const RealtimeSpectralBank & other ) noexcept;
+
+    //! Return how many samples the segments have to be planned ahead.
+    int latency( void ) const noexcept { return HopSize; }
+
+// --- rendering ---
+
+    //! Render frames centered in the planned range and accumulate the
+    //! next block of samples into buffer.
+    //!
+    //! \param  plan        Segments of all Partials, offsets are relative to planStart.
+    //! \param  planStart   Absolute sample index of the first planned sample.
+    //! \param  planSamples Number of planned samples.
+    //! \param  buffer      The samples buffer, results are added to it.
+    //! \param  samples     Number of samples to render.
+    //! \pre    planStart + planSamples is latency() samples after the end
+    //!         of the rendered block, samples is at most the maxSamples
+    //!         given to prepare().
+    void render( const RealtimeOscillatorBank & plan, int planStart, int planSamples,
+                 float * buffer, int samples ) noexcept;
+
+//  --- implementation ---
+private:
+    //! Add the frame centered at absolute sample center to the overlap-add buffer.
+    void renderFrame( const RealtimeOscillatorBank & plan, int planStart, int center ) noexcept;
+
+    FourierTransform m_fft;                 //  inverse transform done by forward one
+    std::vector< double > m_kernel;         //  main lobe of the window transform, 1/FrameSize scaled
+    std::vector< double > m_synthesisWindow;//  triangle divided by the window
+    std::vector< float > m_overlapAdd;      //  samples from m_overlapAddStart on, between blocks
+                                            //  only the first 2 * HopSize are not zero
+    int m_overlapAddStart;                  //  absolute index of the first sample of m_overlapAdd
+    int m_nextCenter;                       //  absolute center of the next frame
+
+};  //  end of class RealtimeSpectralBank
+
+}   //  end of namespace Loris
+
+#endif /* ndef INCLUDE_REALTIME_SPECTRAL_BANK_H */
@@ -34,7 +34,6 @@
     #include "config.h"
 #endif
 #include "RealtimeSynthesizer.h"
-#include "RealtimeOscillator.h"
 #include "Breakpoint.h"
 #include "BreakpointUtils.h"
 #include "Envelope.h"
@@ -51,6 +50,9 @@
 
 //  begin namespace
 namespace Loris {
+
+const double RealTimeSynthesizer::DetailFadeTime = 0.02;
+
 // ---------------------------------------------------------------------------
 //  Synthesizer constructor
 // ---------------------------------------------------------------------------
@@ -88,57 +90,90 @@ RealTimeSynthesizer::RealTimeSynthesizer( std::vector<float> & buffer ) :
 //!         by given partials.
 void RealTimeSynthesizer::setup(PartialList & partials, double pitch) noexcept
 {
-    this->partials.clear();
+    setup( RealtimePartialBank::create( partials, m_fadeTimeSec, m_srateHz ), pitch );
+}
+
+// ---------------------------------------------------------------------------
+//  setup
+// ---------------------------------------------------------------------------
+//!	Prepare internal structures for synthesis of a shared Partial bank.
+//! Only the per-Partial playback state is allocated, the bank is not
+//! copied. reset() is also called. Previous data is released.
+//!
+//! \param  bank The Partials to synthesize.
+//! \param  pitch original pitch of the partials
+//! \return Nothing.
+//! \post   This RealTimeSynthesizer's is ready for synthesise the sound specified
+//!         by given bank.
+void RealTimeSynthesizer::setup(const RealtimePartialBank::Ptr & bank, double pitch) noexcept
+{
+    this->bank = bank;
     this->pitch = pitch;
-    clearPartialsBeingProcessed();
-    
-    // assuming I am getting sorted partials by time
-    for (auto it : partials)
-    {
-        if (it.numBreakpoints() <= 0) continue;
-        
-        PartialStruct pStruct;
-        
-        pStruct.numBreakpoints = it.numBreakpoints() + 2;// + fade in + fade out
 
-        pStruct.breakpoints.reserve(pStruct.numBreakpoints);
-        pStruct.label = it.label();
-        
-        pStruct.startTime = ( m_fadeTimeSec < it.startTime() ) ? ( it.startTime() - m_fadeTimeSec ) : 0.;// compute fade in bp time
-        pStruct.endTime = it.endTime() + m_fadeTimeSec;// compute fade out bp time
+    states.assign( bank ? bank->size() : 0, PartialState() );
+    activePartials.clear();
+    activePartials.reserve( bank ? bank->maxActivePartials() : 0 );
+    m_oscillators.prepare( maxBlockSize, bank ? bank->maxSegments( maxBlockSize + m_spectral.latency() ) : 0 );
+    m_spectral.prepare( maxBlockSize );
+    setDetail( detail );
 
-        
-        // breakpoints
-        Partial::const_iterator jt = it.begin();
-        // fade in breakpoint, compute fade in time
-        pStruct.breakpoints.push_back(std::make_pair(pStruct.startTime, BreakpointUtils::makeNullBefore( jt.breakpoint(), it.startTime() - pStruct.startTime)));
-        
+    reset();
+}
 
-        
-        double sumF = 0;
-        
-        for (; jt != it.end(); jt++)
-        {
-            sumF += jt->frequency();
-            pStruct.breakpoints.push_back(std::make_pair(jt.time(), jt.breakpoint()));
-        }
-        
-        pStruct.avgFrequency = sumF / (float) it.numBreakpoints();
-        
-        // fade out breakpoint
-        jt--;
-        pStruct.breakpoints.push_back(std::make_pair(jt.time() + m_fadeTimeSec, BreakpointUtils::makeNullAfter( jt.breakpoint(), m_fadeTimeSec )));
-        
-        this->partials.push_back(pStruct);
-//        pStruct.breakpoints[0].second.setAmplitude(pStruct.breakpoints[1].second.amplitude());
+// ---------------------------------------------------------------------------
+//  continueFrom
+// ---------------------------------------------------------------------------
+//!	Continue the sound of another synthesizer, set up with a bank
+//! extending the bank of previous. Playback state, pitch and level of
+//! detail are copied.
+//!
+//! \param  previous The synthesizer to continue.
+//! \return Nothing.
+void RealTimeSynthesizer::continueFrom(const RealTimeSynthesizer & previous) noexcept
+{
+    pitch = previous.pitch;
+    frequencyScaling = previous.frequencyScaling;
+    noiseSeed = previous.noiseSeed;
+    
+    //  the Partials of the previous bank come first, new Partials
+    //  start later and keep their initial state
+    std::size_t numStates = std::min( states.size(), previous.states.size() );
+    std::copy( previous.states.begin(), previous.states.begin() + numStates, states.begin() );
+    
+    //  the bank extends the previous one, so it has at least as many
+    //  Partials sounding at once and activePartials does not allocate
+    activePartials.clear();
+    for ( int idx : previous.activePartials )
+    {
+        if ( idx < (int) states.size() )
+            activePartials.push_back( idx );
     }
-
     
-    reset();
+    processedSamples = previous.processedSamples;
+    plannedSamples = previous.plannedSamples;
+    
+    //  Partials starting before the planned samples are admitted,
+    //  new Partials start after the available samples of the previous bank
+    admissionIdx = 0;
+    if ( bank )
+    {
+        const BankArray<PartialStruct> &partials = bank->partials();
+        const BankArray<int> &startOrder = bank->startOrder();
+        admissionIdx = int( std::upper_bound( startOrder.begin(), startOrder.end(), plannedSamples,
+                                              [&partials]( int sample, int idx ) { return sample < partials[idx].startSample; } )
+                            - startOrder.begin() );
+    }
+    
+    //  keep the engine, the inverse FFT has samples in overlap-add
+    useInverseFFT = previous.useInverseFFT;
+    if ( useInverseFFT )
+        m_spectral.continueFrom( previous.m_spectral );
+    
+    setDetail( previous.detail );
 }
 
 // ---------------------------------------------------------------------------
-//  setup
+//  setSampleRate
 // ---------------------------------------------------------------------------
 //!	Set sample rate.
 //!
@@ -161,9 +196,15 @@ void RealTimeSynthesizer::setSampleRate(double rate)
 //! \return Nothing.
 void RealTimeSynthesizer::reset() noexcept
 {
-    partialIdx = 0;
+    admissionIdx = 0;
     processedSamples = 0;
-    clearPartialsBeingProcessed();
+    plannedSamples = 0;
+    activePartials.clear();
+    
+    useInverseFFT = engine == InverseFFTEngine ||
+        ( engine == AutomaticEngine && bank && bank->maxActivePartials() >= getInverseFFTThreshold() &&
+          bank->noiseEnergy() * 100 <= InverseFFTMaxNoisePercent );
+    m_spectral.reset();
 }
 
 // ---------------------------------------------------------------------------
@@ -175,7 +216,21 @@ void RealTimeSynthesizer::reset() noexcept
 //! \return Nothing.
 void RealTimeSynthesizer::setPitch(double frequency) noexcept
 {
-    m_osc.setFrequencyScaling(frequency / pitch);
+    frequencyScaling = frequency / pitch;
+}
+
+// ---------------------------------------------------------------------------
+//  setDetail
+// ---------------------------------------------------------------------------
+//!	Set the level of detail. Only the loudest Partials of the bank
+//! are rendered, the others fade out over DetailFadeTime and are skipped.
+//!
+//! \param  detail Fraction of the Partials to render, 0 to 1.
+//! \return Nothing.
+void RealTimeSynthesizer::setDetail(double detail) noexcept
+{
+    this->detail = std::min( std::max( detail, 0. ), 1. );
+    detailPartials = bank ? (int) std::ceil( this->detail * bank->size() ) : 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -191,86 +246,144 @@ void RealTimeSynthesizer::setPitch(double frequency) noexcept
 //!         next block of samples starting at 'previous count of samples' + samples.
 void RealTimeSynthesizer::synthesizeNext( int samples ) noexcept
 {
-    //TODO: check processedSamples overflow
-    processedSamples += samples;// for performance reason this is computed at the beginning
-    PartialStruct *partial;
+    assert( samples <= maxBlockSize );
     
     // prepare buffer for new data
     if (buffer->capacity() < samples)
         buffer->reserve(samples);
-    memset(buffer->data(), 0, samples * sizeof(decltype(buffer->data())));
+    memset(buffer->data(), 0, samples * sizeof(float));
     
+    // wait silently at the end of partials still being analysed
+    if (bank && processedSamples + samples + ( useInverseFFT ? m_spectral.latency() : 0 ) > bank->availableSamples())
+        return;
     
-    // process partials being processed
-    int size = partialsBeingProcessed.size();
-    for (int i = 0; i < size; i++)
+    //TODO: check processedSamples overflow
+    processedSamples += samples;// for performance reason this is computed at the beginning
+    int idx;
+    
+    if (!bank)
+        return;
+    
+    // the inverse FFT needs the segments planned ahead
+    int planStart = plannedSamples;
+    int planSamples = processedSamples + ( useInverseFFT ? m_spectral.latency() : 0 ) - plannedSamples;
+    plannedSamples += planSamples;
+    
+    m_oscillators.clear( planStart );
+    
+    const BankArray<PartialStruct> &partials = bank->partials();
+    
+    // continue active partials, retire the ones ending in this block
+    // by moving the last one in their place. Only partials sounding at
+    // plannedSamples stay active, never more than bank->maxActivePartials(),
+    // so activePartials does not allocate.
+    for (std::size_t i = 0; i < activePartials.size(); )
     {
-        partial = partialsBeingProcessed.front();
-        synthesize( *partial, buffer->data(), samples );
-        
-        if ( partial->state.lastBreakpointIdx < partial->numBreakpoints - 1)
-            partialsBeingProcessed.push( partial );
+        idx = activePartials[i];
+        synthesize( partials[idx], states[idx], 0, planSamples );
         
-        partialsBeingProcessed.pop();
+        if ( partials[idx].endSample <= plannedSamples )
+        {
+            activePartials[i] = activePartials.back();
+            activePartials.pop_back();
+        }
+        else
+            ++i;
     }
     
-    // partials to be processed
-    int partialSize = partials.size();
-    for (; partialIdx < partialSize; partialIdx++)
+    // admit partials starting in this block
+    const BankArray<int> &startOrder = bank->startOrder();
+    int partialSize = startOrder.size();
+    for (; admissionIdx < partialSize; admissionIdx++)
     {
-        partial = &(partials[partialIdx]);
+        idx = startOrder[admissionIdx];
+        const PartialStruct &partial = partials[idx];
+        PartialState &state = states[idx];
         
         // setup partial for synthesis
-        partial->state.currentSamp = index_type( (partial->startTime * m_srateHz) + 0.5 );   //  cheap rounding
-
-        if (partial->state.currentSamp > processedSamples)
+        if (partial.startSample > plannedSamples)
             break;
         
-        partial->state.lastBreakpointIdx = PartialStruct::NoBreakpointProcessed;
-        partial->state.envelope = partial->breakpoints[0].second;
-        partial->state.breakpointFinished = true;
-
-        //  cache the previous frequency (in Hz) so that it can be used to reset the phase when necessary
-        partial->state.prevFrequency = m_osc.frequencyScaling() * partial->breakpoints[1].second._frequency;// 0 is null breakpoint
+        state.currentSamp = partial.startSample;
+        state.lastBreakpointIdx = PartialStruct::NoBreakpointProcessed;
+        state.breakpointFinished = true;
+        state.phaseKnown = false;
+        state.noise.key = idx + noiseSeed * 0x9e3779b9u;
+        state.noise.reset();
+        state.detailGain = partial.loudnessRank < detailPartials ? 1. : 0.;
         
-        int sampleCount = processedSamples - partial->state.currentSamp; // how much sample to be processed during this call
-        int sampleDelta = samples - sampleCount; // delta when partial should start
+        int sampleCount = plannedSamples - state.currentSamp; // how much sample to be processed during this call
+        int sampleDelta = planSamples - sampleCount; // delta when partial should start
 
-        synthesize( *partial, buffer->data() + sampleDelta, sampleCount );
+        synthesize( partial, state, sampleDelta, sampleCount );
         
-        if ( partial->state.lastBreakpointIdx < partial->numBreakpoints - 1)
-            partialsBeingProcessed.push(partial);
+        if ( partial.endSample > plannedSamples )
+            activePartials.push_back( idx );
     }
+    
+    if ( useInverseFFT )
+        m_spectral.render( m_oscillators, planStart, planSamples, buffer->data(), samples );
+    else
+        m_oscillators.render( buffer->data(), samples );
 }
     
 // ---------------------------------------------------------------------------
 //  synthesize
 // ---------------------------------------------------------------------------
-//! Synthesize a bandwidth-enhanced sinusoidal Partial.
+//! Plan synthesis of a bandwidth-enhanced Partial. Segments of the
+//! Partial are handed to the oscillator bank, which renders all
+//! Partials of the block at once.
 //!
-//! \param  buffer  The samples buffer.
+//! \param  offset  The first sample of the block to be synthesized.
 //! \param  samples Number of samples to be synthesized.
 //! \param  p       The Partial to synthesize.
+//! \param  state   The playback state of the Partial.
 //! \return Nothing.
-//! \pre    The buffer has to have capacity to contain all samples.
-//! \post   This RealTimeSynthesizer's sample buffer (vector) contain synthesised
-//!         partials and storeed inner state of synthesiser.
+//! \post   The playback state of the Partial is advanced by samples.
 //!
-void RealTimeSynthesizer::synthesize( PartialStruct &p, float * buffer, const int samples) noexcept
+void RealTimeSynthesizer::synthesize( const PartialStruct &p, PartialState &state, int offset, const int samples) noexcept
 {
-    if (p.state.lastBreakpointIdx == PartialStruct::NoBreakpointProcessed)
-        m_osc.resetEnvelopes( p.state.envelope, m_srateHz );
-    else
-        m_osc.restoreEnvelopes( p.state.envelope );
-        
+    const RealtimePartialBank::BreakpointArrays &bps = bank->breakpoints();
+    const int *bpSample = bps.sample.data() + p.firstBreakpoint;
+    const float *bpFrequency = bps.frequency.data() + p.firstBreakpoint;
+    const float *bpAmplitude = bps.amplitude.data() + p.firstBreakpoint;
+    const float *bpBandwidth = bps.bandwidth.data() + p.firstBreakpoint;
+    const float *bpPhase = bps.phase.data() + p.firstBreakpoint;
+    const float *bpFrequencyIncrement = bps.frequencyIncrement.data() + p.firstBreakpoint;
+    const float *bpAmplitudeIncrement = bps.amplitudeIncrement.data() + p.firstBreakpoint;
+    const float *bpBandwidthIncrement = bps.bandwidthIncrement.data() + p.firstBreakpoint;
+    
+    const double scaling = frequencyScaling;
+    
+    //  level of detail crossfade, linear over the whole block
+    double gain = state.detailGain;
+    double dGain = 0.;
+    double targetGain = p.loudnessRank < detailPartials ? 1. : 0.;
+    if ( gain != targetGain && samples > 0 )
+    {
+        double step = samples / ( DetailFadeTime * m_srateHz );
+        double endGain = ( targetGain > gain ) ? std::min( gain + step, 1. ) : std::max( gain - step, 0. );
+        dGain = ( endGain - gain ) / samples;
+        state.detailGain = endGain;
+    }
+    
+    //  culled, or above Nyquist during its whole life at this pitch
+    if ( ( gain <= 0. && targetGain <= 0. ) || p.minFrequency * scaling > Pi )
+    {
+        skip( p, state, samples );
+        return;
+    }
+    
+    const int firstOffset = offset;
+    bool partialBegun = false;
     int sampleCounter = 0;
 	int sampleDiff = 0;
     int i;
-    for (i = p.state.lastBreakpointIdx + 1;  i < p.numBreakpoints; ++i )
+    for (i = state.lastBreakpointIdx + 1;  i < p.numBreakpoints; ++i )
     {
-        index_type tgtSamp = index_type( (p.breakpoints[i].first * m_srateHz) + 0.5 );   //  cheap rounding
+        int tgtSamp = bpSample[i];
         
-        sampleCounter += sampleDiff = tgtSamp - p.state.currentSamp;
+        sampleCounter += sampleDiff = tgtSamp - state.currentSamp;
         
         if (sampleCounter > samples)// if this breakpoint is longer...
         {
@@ -279,14 +392,38 @@ void RealTimeSynthesizer::synthesize( PartialStruct &p, float * buffer, const in
             sampleCounter = samples; // we can process max "samples" count
         }
         
-        Breakpoint *bp = &(p.breakpoints[i].second);
+        if ( state.breakpointFinished || !state.phaseKnown )
+        {
+            // new segment, start it exactly at the previous breakpoint,
+            // or inside of it after the partial was skipped
+            int elapsed = state.currentSamp - bpSample[i - 1];
+            double targetFreq = scaling * bpFrequency[i];
+            
+            state.dFrequency = scaling * bpFrequencyIncrement[i];
+            state.frequency = scaling * bpFrequency[i - 1] + elapsed * state.dFrequency;
+            state.dAmplitude = bpAmplitudeIncrement[i];
+            state.amplitude = bpAmplitude[i - 1] + elapsed * state.dAmplitude;
+            state.dBandwidth = bpBandwidthIncrement[i];
+            state.bandwidth = bpBandwidth[i - 1] + elapsed * state.dBandwidth;
+            double startFreq = state.frequency;
+            
+            //  don't alias:
+            if ( startFreq > Pi || targetFreq > Pi )  //  radian Nyquist rate
+            {
+                double targetAmp = targetFreq > Pi ? 0. : bpAmplitude[i];
+                if ( startFreq > Pi )
+                    state.amplitude = 0.;
+                state.dAmplitude = ( tgtSamp > state.currentSamp ) ? ( targetAmp - state.amplitude ) / ( tgtSamp - state.currentSamp ) : 0.;
+            }
+        }
+        
         //  if the current oscillator amplitude is
         //  zero, and the target Breakpoint amplitude
         //  is not, reset the oscillator phase so that
         //  it matches exactly the target Breakpoint 
-        //  phase at tgtSamp:
-//        if ( m_osc.amplitude() == 0. && p.state.breakpointFinished )
-        if ( i == PartialStruct::NoBreakpointProcessed + 1 && p.state.breakpointFinished )
+        //  phase at tgtSamp. The same is done when a
+        //  skipped partial becomes audible:
+        if ( !state.phaseKnown )
         {
             //  recompute the phase so that it is correct
             //  at the target Breakpoint (need to do this
@@ -295,9 +432,12 @@ void RealTimeSynthesizer::synthesize( PartialStruct &p, float * buffer, const in
             //  it might be inaccurate):
             //
             //  double favg = 0.5 * ( prevFrequency + it.breakpoint().frequency() );
-            //  double dphase = 2 * Pi * favg * ( tgtSamp - currentSamp ) / m_srateHz;
+            //  double dphase = favg * ( tgtSamp - currentSamp );
+            //
+            //  fade in breakpoint has the same frequency as the first one,
+            //  both in radians per sample.
             
-            double dphase = Pi * ( p.state.prevFrequency + m_osc.frequencyScaling() * bp->frequency() ) * ( tgtSamp - p.state.currentSamp ) * OneOverSrate;
+            double dphase = 0.5 * ( state.frequency + scaling * bpFrequency[i] ) * ( tgtSamp - state.currentSamp );
             
             // If we transposed/pitch-shifted the sound using sample rate change, the transpose octave above would
             // mean create new signal with every second sample missing, so the partial would start earlier. If we
@@ -306,29 +446,51 @@ void RealTimeSynthesizer::synthesize( PartialStruct &p, float * buffer, const in
             // The start time in sample-removing pitch shifted signal would be half of time if we transpose octave up so the
             // delta time is t0 - t0/transposeFactor. So the new phase goes like this (here we do not have time t0 so we get
             // it from partial[iSamp]/float(fs)).
-            double phaseFixed = (bp->phase() + 2*Pi*p.avgFrequency*p.state.currentSamp*OneOverSrate*(m_osc.frequencyScaling()-1));
+            double phaseFixed = (bpPhase[i] + p.avgFrequency*state.currentSamp*(scaling-1));
 
-            m_osc.setPhase( phaseFixed - dphase );
+            state.phase = wrapPi( phaseFixed - dphase );
+            state.phaseKnown = true;
         }
         
-        int samplesToBp = tgtSamp - p.state.currentSamp;
-        m_osc.oscillate( buffer, buffer + sampleDiff, *bp, m_srateHz, samplesToBp );
-
-		buffer += sampleDiff;// move buffer pointer
-        
-		p.state.currentSamp += sampleDiff;
-        p.state.breakpointFinished = tgtSamp == p.state.currentSamp;
-
-        if (p.state.breakpointFinished)
+        if ( sampleDiff > 0 )
         {
-            //  remember the frequency, may need it to reset the
-            //  phase if a Null Breakpoint is encountered:
-//            m_osc.resetEnvelopes(*bp, m_srateHz);
-//            p.state.prevFrequency = bp->frequency();
+            //  silent segments (above Nyquist, zero amplitude) are not
+            //  rendered, only the phase is advanced
+            if ( state.amplitude > 0. || state.amplitude + sampleDiff * state.dAmplitude > 0. )
+            {
+                if ( !partialBegun )
+                {
+                    m_oscillators.beginPartial( &state.noise );
+                    partialBegun = true;
+                }
+                double amplitude = state.amplitude;
+                double dAmplitude = state.dAmplitude;
+                if ( dGain != 0. || gain < 1. )
+                {
+                    //  crossfade, the amplitude stays linear in the segment
+                    double g0 = gain + ( offset - firstOffset ) * dGain;
+                    double g1 = g0 + sampleDiff * dGain;
+                    amplitude = state.amplitude * g0;
+                    dAmplitude = ( ( state.amplitude + sampleDiff * state.dAmplitude ) * g1 - amplitude ) / sampleDiff;
+                }
+                m_oscillators.addSegment( offset, sampleDiff, state.phase,
+                                          state.frequency, state.dFrequency,
+                                          amplitude, dAmplitude,
+                                          state.bandwidth, state.dBandwidth );
+            }
             
-            p.state.prevFrequency = m_osc.envelopes().frequency();
-//                m_osc.setPhase(bp->phase());
+            //  advance the oscillator state to the end of the segment,
+            //  the same recurrence the oscillator bank uses per sample
+            state.phase = wrapPi( state.phase + sampleDiff * ( state.frequency + 0.5 * state.dFrequency * sampleDiff ) );
+            state.frequency += sampleDiff * state.dFrequency;
+            state.amplitude += sampleDiff * state.dAmplitude;
+            state.bandwidth += sampleDiff * state.dBandwidth;
         }
+
+		offset += sampleDiff;// move buffer offset
+        
+		state.currentSamp += sampleDiff;
+        state.breakpointFinished = tgtSamp == state.currentSamp;
         
         if (sampleCounter == samples)
         {
@@ -337,8 +499,33 @@ void RealTimeSynthesizer::synthesize( PartialStruct &p, float * buffer, const in
         }
 	}
     
-    p.state.envelope = m_osc.envelopes();
-    p.state.lastBreakpointIdx = i;
+    state.lastBreakpointIdx = i;
+}
+    
+// ---------------------------------------------------------------------------
+//  skip
+// ---------------------------------------------------------------------------
+//! Advance the playback state of a Partial that is not rendered, only
+//! the position is moved. The phase is resynchronized when it becomes
+//! audible again.
+//!
+//! \param  p       The Partial to skip.
+//! \param  state   The playback state of the Partial.
+//! \param  samples Number of samples to skip.
+//! \return Nothing.
+void RealTimeSynthesizer::skip( const PartialStruct &p, PartialState &state, const int samples) noexcept
+{
+    const int *bpSample = bank->breakpoints().sample.data() + p.firstBreakpoint;
+    
+    int target = std::min( state.currentSamp + samples, bpSample[p.numBreakpoints - 1] );
+    int i = std::max( state.lastBreakpointIdx, 0 );
+    while ( i + 1 < p.numBreakpoints - 1 && bpSample[i + 1] <= target )
+        ++i;
+    
+    state.currentSamp = target;
+    state.lastBreakpointIdx = i;
+    state.breakpointFinished = false;
+    state.phaseKnown = false;
 }
     
 }   //  end of namespace Loris
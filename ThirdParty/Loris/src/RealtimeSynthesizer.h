@@ -34,10 +34,11 @@
  */
  
 #include "Synthesizer.h"
-#include "RealtimeOscillator.h"
+#include "RealtimeOscillatorBank.h"
+#include "RealtimePartialBank.h"
+#include "RealtimeSpectralBank.h"
 
 #include <vector>
-#include <queue>
 #include <cmath>
 
 #if defined(HAVE_M_PI) && (HAVE_M_PI)
@@ -48,28 +49,23 @@ const double Pi = 3.14159265358979324;
 
 //	begin namespace
 namespace Loris {
-// Using this struct because iterating over partials and especially Breakpoint is very
-// expensive. So I wrote this data container.
-struct PartialStruct
+// Per-voice playback state of one PartialStruct. The Partial data itself
+// lives in a shared RealtimePartialBank.
+struct PartialState
 {
-    enum { NoBreakpointProcessed = 0, FirstBreakpoint };
-    
-    double startTime = 0.0;
-    double endTime = 0.0;
-    int numBreakpoints = 0;
-    int label = 0;
-    float avgFrequency = 0;
-
-    std::vector<std::pair<double, Breakpoint>> breakpoints;
-    
-    struct SynthesizerState
-    {
-        int currentSamp = 0;
-        int lastBreakpointIdx = NoBreakpointProcessed;
-        Breakpoint envelope;
-        double prevFrequency;
-        bool breakpointFinished = true;
-    } state;
+    int currentSamp = 0;
+    int lastBreakpointIdx = PartialStruct::NoBreakpointProcessed;
+    double frequency = 0.;      // radians per sample, scaled
+    double amplitude = 0.;
+    double phase = 0.;
+    double bandwidth = 0.;
+    double dFrequency = 0.;     // increments of current segment
+    double dAmplitude = 0.;
+    double dBandwidth = 0.;
+    double detailGain = 1.;     // level of detail crossfade, 0 when culled
+    bool breakpointFinished = true;
+    bool phaseKnown = false;    // false until the first audible segment
+    RealtimeOscillatorBank::Noise noise;    // bandwidth-enhancement noise
 };
 // ---------------------------------------------------------------------------
 //	class RealTimeSynthesizer
@@ -89,6 +85,25 @@ class RealTimeSynthesizer : public Synthesizer
 {
 //	-- public interface --
 public:
+    //! Synthesis engines. OscillatorBankEngine renders every Partial in time
+    //! domain (RealtimeOscillatorBank), InverseFFTEngine by inverse FFT and
+    //! overlap-add (RealtimeSpectralBank). Only the oscillator bank renders
+    //! the bandwidth-enhancement noise, the inverse FFT renders pure
+    //! sinusoids. AutomaticEngine chooses the inverse FFT for banks with at
+    //! least getInverseFFTThreshold() Partials sounding at the same time and
+    //! at most InverseFFTMaxNoisePercent of their energy in noise.
+    enum SynthesisEngine { OscillatorBankEngine = 0, InverseFFTEngine, AutomaticEngine };
+    
+    //! The inverse FFT costs about as much as the oscillator bank with
+    //! this many Partials per SIMD lane.
+    enum { InverseFFTPartialsPerLane = 20 };
+
+    //! Noise 20 dB below the sinusoids may be left out by AutomaticEngine.
+    enum { InverseFFTMaxNoisePercent = 1 };
+    
+    //! Longest block unless setMaxBlockSize() is called.
+    enum { DefaultMaxBlockSize = 4096 };
+    
 //	-- construction --
     //!	Construct a Synthesizer using the default parameters and sample
     //!	buffer (a standard library vector). Since Partials generated by the
@@ -122,17 +137,53 @@ public:
     //!         by given partials.
     void setup(PartialList & partials, double pitch) noexcept;
 
+    //!	Prepare internal structures for synthesis of a shared Partial bank.
+    //! Only the per-Partial playback state is allocated, the bank is not
+    //! copied. reset() is also called. Previous data is released.
+    //!
+    //! \param  bank The Partials to synthesize.
+    //! \param  pitch original pitch of the partials
+    //! \return Nothing.
+    //! \post   This RealTimeSynthesizer's is ready for synthesise the sound specified
+    //!         by given bank.
+    void setup(const RealtimePartialBank::Ptr & bank, double pitch) noexcept;
+
+    //!	Continue the sound of another synthesizer, set up with a bank
+    //! extending the bank of previous (see RealtimePartialBank::availableSamples()).
+    //! The Partials of the bank of previous have to be the first Partials
+    //! of the bank of this synthesizer, in the same order, possibly with
+    //! Breakpoints appended after the available samples. Playback state,
+    //! pitch and level of detail are copied, so the sound goes on without
+    //! interruption. It does not allocate.
+    //!
+    //! \param  previous The synthesizer to continue, set up for the same
+    //!         sample rate.
+    //! \return Nothing.
+    void continueFrom(const RealTimeSynthesizer & previous) noexcept;
+
     //!	Set sample rate.
     //!
     //! \param  rate new sample rate
     //! \return Nothing.
     void setSampleRate(double rate) override;
     
+    //!	Set the longest block synthesizeNext() is called with, the
+    //! default is DefaultMaxBlockSize. It is applied by the next setup(),
+    //! which preallocates everything a block needs.
+    //!
+    //! \param  samples The longest block in samples.
+    //! \return Nothing.
+    void setMaxBlockSize(int samples) noexcept { maxBlockSize = samples; }
+    
+    //!	Return the longest block synthesizeNext() can be called with.
+    int getMaxBlockSize() const noexcept { return maxBlockSize; }
+    
     //!	Synthesize next block of samples of the partials. The synthesizer
     //! will resize the inner buffer as necessary. Previous contents of the buffer
-    //! are overwritten.
+    //! are overwritten. Blocks past the available samples of the bank are
+    //! silent, the synthesizer waits there.
     //!
-    //! \param  sample Number of samples to synthesize.
+    //! \param  sample Number of samples to synthesize, at most getMaxBlockSize().
     //! \return Nothing.
     //! \post   Internal state of synthesizer changes - it is ready to synthesize
     //!         next block of samples starting at 'previous count of samples' + samples.
@@ -150,42 +201,116 @@ public:
     //! \return Nothing.
     void setPitch(double frequency) noexcept;
     
+    //!	Select the oscillator algorithm, see RealtimeOscillatorBank::Mode.
+    //!
+    //! \param  mode The oscillator algorithm.
+    //! \return Nothing.
+    void setOscillatorMode(RealtimeOscillatorBank::Mode mode) noexcept { m_oscillators.setMode(mode); }
+    
+    //!	Return the oscillator algorithm.
+    RealtimeOscillatorBank::Mode oscillatorMode() const noexcept { return m_oscillators.mode(); }
+    
+    //!	Select the synthesis engine. It is applied by the next reset().
+    //!
+    //! \param  engine The synthesis engine.
+    //! \return Nothing.
+    void setSynthesisEngine(SynthesisEngine engine) noexcept { this->engine = engine; }
+    
+    //!	Return the selected synthesis engine.
+    SynthesisEngine synthesisEngine() const noexcept { return engine; }
+    
+    //!	Set number of Partials sounding at once from which AutomaticEngine
+    //! uses the inverse FFT. It is applied by the next reset().
+    //!
+    //! \param  partials The number of Partials, 0 to derive it from the
+    //!         SIMD width of the oscillator bank (the default).
+    //! \return Nothing.
+    void setInverseFFTThreshold(int partials) noexcept { inverseFFTThreshold = partials; }
+    
+    //!	Return the number of Partials from which AutomaticEngine uses the inverse FFT.
+    int getInverseFFTThreshold() const noexcept
+    {
+        return inverseFFTThreshold > 0 ? inverseFFTThreshold : InverseFFTPartialsPerLane * m_oscillators.lanes();
+    }
+    
+    //!	Return true if the inverse FFT engine is used since the last reset().
+    bool isUsingInverseFFT() const noexcept { return useInverseFFT; }
+    
+    //!	Select the random sequences of the bandwidth-enhancement noise, so
+    //! that voices playing the same sound do not share the noise. It is
+    //! applied to Partials starting after the call. The default is 1.
+    //!
+    //! \param  seed The seed of the noise of this synthesizer.
+    //! \return Nothing.
+    void setNoiseSeed(uint32_t seed) noexcept { noiseSeed = seed; }
+    
+    //!	Set the level of detail. Only the loudest Partials of the bank
+    //! (by peak amplitude, see RealtimePartialBank::loudnessOrder()) are
+    //! rendered, the others fade out over DetailFadeTime and are skipped.
+    //! Skipped Partials keep their position and fade back in, with the
+    //! phase resynchronized, when the detail is raised again.
+    //!
+    //! \param  detail Fraction of the Partials to render, 0 to 1, 1 is
+    //!         full detail (the default).
+    //! \return Nothing.
+    void setDetail(double detail) noexcept;
+    
+    //!	Return the level of detail.
+    double getDetail() const noexcept { return detail; }
+    
+    //!	Fade time in seconds of Partials culled or restored by setDetail().
+    static const double DetailFadeTime;
+    
  	
 //	-- parameter access and mutation --
 //	-- implementation --
 private:
     
     //	-- synthesis --
-    //! Synthesize a bandwidth-enhanced sinusoidal Partial.
+    //! Plan synthesis of a bandwidth-enhanced Partial. Segments of the
+    //! Partial are handed to the oscillator bank, which renders all
+    //! Partials of the block at once.
     //!
-    //! \param  buffer  The samples buffer.
+    //! \param  offset  The first sample of the block to be synthesized.
     //! \param  samples Number of samples to be synthesized.
     //! \param  p       The Partial to synthesize.
+    //! \param  state   The playback state of the Partial.
     //! \return Nothing.
-    //! \pre    The buffer has to have capacity to contain all samples.
-    //! \post   This RealTimeSynthesizer's sample buffer (vector) contain synthesised
-    //!         partials and storeed inner state of synthesiser.
+    //! \post   The playback state of the Partial is advanced by samples.
     //!
-    void synthesize( PartialStruct &p, float * buffer, const int samples) noexcept;
+    void synthesize( const PartialStruct &p, PartialState &state, int offset, const int samples) noexcept;
     
-    void clearPartialsBeingProcessed() noexcept
-	{
-		while (!partialsBeingProcessed.empty())
-			partialsBeingProcessed.pop();
-	}
+    //! Advance the playback state of a Partial that is not rendered.
+    //! The phase is resynchronized when it becomes audible again.
+    //!
+    //! \param  p       The Partial to skip.
+    //! \param  state   The playback state of the Partial.
+    //! \param  samples Number of samples to skip.
+    //! \return Nothing.
+    void skip( const PartialStruct &p, PartialState &state, const int samples) noexcept;
     
-    RealtimeOscillator m_osc; 	//  the Synthesizer has-a Oscillator that it uses to render
-                                //  all the Partials one by one.
+    RealtimeOscillatorBank m_oscillators;   //  renders all the Partials of a block at once
+    RealtimeSpectralBank m_spectral;        //  or renders them by inverse FFT
+    SynthesisEngine engine = AutomaticEngine;
+    int inverseFFTThreshold = 0;            //  0 derives it from SIMD width
+    bool useInverseFFT = false;             //  engine chosen by reset()
+    int maxBlockSize = DefaultMaxBlockSize; //  longest block, applied by setup()
+    uint32_t noiseSeed = 1;                 //  noise keys of the Partials
+    double detail = 1.;                     //  level of detail, fraction of Partials rendered
+    int detailPartials = 0;                 //  Partials with lower loudnessRank are rendered
+    double frequencyScaling = 1.;           //  current pitch / original pitch
     
     double OneOverSrate = 0;
     typedef unsigned long index_type;
     
     double pitch = 0.;                      // original pitch of partial data
     
-    std::vector<PartialStruct> partials;
-    int partialIdx;                         // last loaded partial
+    RealtimePartialBank::Ptr bank;          // shared partial data
+    std::vector<PartialState> states;       // playback state of each partial in the bank
+    int admissionIdx = 0;                   // next partial to start, index into bank->startOrder()
     int processedSamples = 0;               // internal sample position counter
-    std::queue<PartialStruct* > partialsBeingProcessed; // partials not finished yet
+    int plannedSamples = 0;                 // samples planned, ahead of processedSamples by engine latency
+    std::vector<int> activePartials;        // indices of partials not finished yet, unordered
     std::vector<float> *buffer;             // sample buffer
     std::vector<double> xxx;                // buffer to satisfy Synthesizer constructor
     
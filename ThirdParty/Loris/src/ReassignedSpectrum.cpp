@@ -22,7 +22,7 @@
  *
  * ReassignedSpectrum.C
  *
- * Implementation of class Loris::ReassignedSpectrum.
+ * Implementation of class template Loris::BasicReassignedSpectrum.
  *
  * Kelly Fitz, 9 Dec 1999
  * loris@cerlsoundgroup.org
@@ -79,13 +79,21 @@ static unsigned long nextPO2( unsigned long N )
 //!	Transform lengths are the smallest power of two greater than twice the
 //!	window length.
 //
-ReassignedSpectrum::ReassignedSpectrum( const std::vector< double > & window ) :
+template < typename T >
+BasicReassignedSpectrum< T >::BasicReassignedSpectrum( const std::vector< double > & window ) :
 	mMagnitudeTransform( 1 << ( 1 + nextPO2( window.size() ) ) ),
 	mCorrectionTransform( 1 << ( 1 + nextPO2( window.size() ) ) )
 {	
     //  Build and store the window functions.
 	buildReassignmentWindows( window );                        
 
+    //  Allocate the separated transforms.
+    const size_type halfSize = size() / 2 + 1;
+    mX_h.resize( halfSize );
+    mX_Dh.resize( halfSize );
+    mX_Th.resize( halfSize );
+    mX_TDh.resize( halfSize );
+
 	debugger << "ReassignedSpectrum: length is " << mMagnitudeTransform.size() << endl;
 }
 
@@ -96,18 +104,61 @@ ReassignedSpectrum::ReassignedSpectrum( const std::vector< double > & window ) :
 //! its time derivative.
 //!	Transform lengths are the smallest power of two greater than twice the
 //!	window length.
-ReassignedSpectrum::ReassignedSpectrum( const std::vector< double > & window,
-                                        const std::vector< double > & windowDerivative ) :
+template < typename T >
+BasicReassignedSpectrum< T >::BasicReassignedSpectrum( const std::vector< double > & window,
+                                                      const std::vector< double > & windowDerivative ) :
 	mMagnitudeTransform( 1 << ( 1 + nextPO2( window.size() ) ) ),
 	mCorrectionTransform( 1 << ( 1 + nextPO2( window.size() ) ) )
 {
     //  Build and store the window functions.
 	buildReassignmentWindows( window, windowDerivative );  
 
+    //  Allocate the separated transforms.
+    const size_type halfSize = size() / 2 + 1;
+    mX_h.resize( halfSize );
+    mX_Dh.resize( halfSize );
+    mX_Th.resize( halfSize );
+    mX_TDh.resize( halfSize );
+
 	debugger << "ReassignedSpectrum: length is " << mMagnitudeTransform.size() << endl;
 }
 
 
+// ---------------------------------------------------------------------------
+//	circEvenPart - helper
+// ---------------------------------------------------------------------------
+// Extract the circular even part from Fourier transform data, given the
+// samples at an index and at the flipped index.
+// Used for computing two real transforms using a single complex transform.
+//
+template < typename T >
+static inline std::complex<T>
+circEvenPart( const std::complex<T> & x, const std::complex<T> & flipped )
+{
+	return T(0.5)*( x + std::conj( flipped ) );
+}   
+
+// ---------------------------------------------------------------------------
+//	circOddPart - helper
+// ---------------------------------------------------------------------------
+// Extract the circular odd part divided by j from Fourier transform data,
+// given the samples at an index and at the flipped index.
+// Used for computing two real transforms using a single complex transform.
+//
+template < typename T >
+static inline std::complex<T>
+circOddPart( const std::complex<T> & x, const std::complex<T> & flipped )
+{
+	/*
+	const std::complex<double> minus_j(0,-1);
+	std::complex<double> tra_part = minus_j * 0.5 * 
+									( x - std::conj( flipped ) );
+	*/
+	//	can compute this without complex multiplies:
+	std::complex<T> tmp = x - std::conj( flipped );
+	return std::complex<T>( T(0.5)*tmp.imag(), T(-0.5)*tmp.real() );
+}   
+
 // ---------------------------------------------------------------------------
 //	transform
 // ---------------------------------------------------------------------------
@@ -128,10 +179,11 @@ ReassignedSpectrum::ReassignedSpectrum( const std::vector< double > & window,
 //!         short-time transform data for the specified 
 //!         samples
 //
+template < typename T >
 void
-ReassignedSpectrum::transform( const double * sampsBegin, 
-                               const double * sampCenter, 
-                               const double * sampsEnd )
+BasicReassignedSpectrum< T >::transform( const T * sampsBegin, 
+                                         const T * sampCenter, 
+                                         const T * sampsEnd )
 {
     if ( sampCenter < sampsBegin ||  sampCenter >= sampsEnd )
     {
@@ -149,39 +201,64 @@ ReassignedSpectrum::transform( const double * sampsBegin,
 	//	only if pos is too close to the start of 
 	//	the buffer:
 	long winBeginOffset = 0; 
-	if ( sampCenter - sampsBegin < (window().size() / 2) )
+	if ( sampCenter - sampsBegin < (long)(window().size() / 2) )
 	{
 		winBeginOffset = (window().size() / 2) - ( sampCenter - sampsBegin );
 	}			
 		
 	//	to get phase right, we will rotate the Fourier transform 
 	//	input by pos - sampsBegin samples:
-	long rotateBy = sampCenter - sampsBegin;
+	const long rotateBy = sampCenter - sampsBegin;
+	const long numSamps = sampsEnd - sampsBegin;
+	const long N = size();
 		
-	//	window and rotate input and compute normal transform:
-	//	window the samples into the FT buffer:
-	FourierTransform::iterator it = 
-		std::transform( sampsBegin, sampsEnd, mCplxWin_W_Wtd.begin() + winBeginOffset, 
-						mMagnitudeTransform.begin(), std::multiplies< std::complex< double > >() );
+	//	window the samples into both FT buffers, rotated while windowing:
+	//	the samples from sampCenter on go to the beginning of the buffers,
+	//	the ones before it wrap around to the end. The samples are real,
+	//	so they just scale the complex-valued windows, the magnitude 
+	//	transform and the dual reassignment transform each compute the
+	//	transforms of two real-windowed inputs at once.
+	std::complex< T > * magBuf = &mMagnitudeTransform[0];
+	std::complex< T > * corBuf = &mCorrectionTransform[0];
+	const std::complex< T > * magWin = &mCplxWin_W_Wtd[ winBeginOffset ];
+	const std::complex< T > * corWin = &mCplxWin_Wd_Wt[ winBeginOffset ];
+	
+	for ( long k = rotateBy; k < numSamps; ++k )
+	{
+		magBuf[ k - rotateBy ] = sampsBegin[ k ] * magWin[ k ];
+		corBuf[ k - rotateBy ] = sampsBegin[ k ] * corWin[ k ];
+	}
+	
 	//	fill the rest with zeros:
-	std::fill( it, mMagnitudeTransform.end(), 0. );
-	//	rotate to align phase:
-	std::rotate( mMagnitudeTransform.begin(), mMagnitudeTransform.begin() + rotateBy, mMagnitudeTransform.end() );
+	std::fill( magBuf + numSamps - rotateBy, magBuf + N - rotateBy, T(0) );
+	std::fill( corBuf + numSamps - rotateBy, corBuf + N - rotateBy, T(0) );
+	
+	for ( long k = 0; k < rotateBy; ++k )
+	{
+		magBuf[ N - rotateBy + k ] = sampsBegin[ k ] * magWin[ k ];
+		corBuf[ N - rotateBy + k ] = sampsBegin[ k ] * corWin[ k ];
+	}
 
-	//	compute transform:
+	//	compute transforms:
 	mMagnitudeTransform.transform();
-
-	//	compute the dual reassignment transform:
-	//	window the samples into the reassignment FT buffer,
-	//	using the complex-valued reassignment window:
-	it = std::transform( sampsBegin, sampsEnd, mCplxWin_Wd_Wt.begin() + winBeginOffset, 
-						 mCorrectionTransform.begin(), std::multiplies< std::complex<double> >() );
-	//	fill the rest with zeros:
-	std::fill( it, mCorrectionTransform.end(), 0. );
-	//	rotate to align phase:
-	std::rotate( mCorrectionTransform.begin(), mCorrectionTransform.begin() + rotateBy, mCorrectionTransform.end() );
-	//	compute the transform:
 	mCorrectionTransform.transform();
+	
+	//	separate the transforms of the real-windowed inputs, once 
+	//	for all the accessors, the circular even part of a transform
+	//	is the transform of the real input, the circular odd part 
+	//	(divided by j) the transform of the imaginary input:
+	magBuf = &mMagnitudeTransform[0];
+	corBuf = &mCorrectionTransform[0];
+	const long halfSize = mX_h.size();
+	for ( long idx = 0; idx < halfSize; ++idx )
+	{
+		const long flip_idx = ( idx != 0 ) ? ( N - idx ) : idx;
+		
+		mX_h[ idx ] = circEvenPart( magBuf[ idx ], magBuf[ flip_idx ] );
+		mX_TDh[ idx ] = circOddPart( magBuf[ idx ], magBuf[ flip_idx ] );
+		mX_Dh[ idx ] = circEvenPart( corBuf[ idx ], corBuf[ flip_idx ] );
+		mX_Th[ idx ] = circOddPart( corBuf[ idx ], corBuf[ flip_idx ] );
+	}
 }
 
 // ---------------------------------------------------------------------------
@@ -189,8 +266,9 @@ ReassignedSpectrum::transform( const double * sampsBegin,
 // ---------------------------------------------------------------------------
 //! Return the length of the Fourier transforms.
 //
-ReassignedSpectrum::size_type 
-ReassignedSpectrum::size( void ) const 
+template < typename T >
+typename BasicReassignedSpectrum< T >::size_type 
+BasicReassignedSpectrum< T >::size( void ) const 
 { 
     return mMagnitudeTransform.size(); 
 }
@@ -202,23 +280,25 @@ ReassignedSpectrum::size( void ) const
 //!	(Peers may need to know about the analysis window
 //!	or about the scale factors in introduces.)
 //
+template < typename T >
 const std::vector< double > &
-ReassignedSpectrum::window( void ) const 
+BasicReassignedSpectrum< T >::window( void ) const 
 { 
     return mWindow; 
 }
 
 // ---------------------------------------------------------------------------
-//	circEvenPartAt - helper
+//	spectrumAt (private)
 // ---------------------------------------------------------------------------
-// Extract the circular even part from Fourier transform data.
-// Used for computing two real transforms using a single complex transform.
+//  Return a sample of a separated transform at any frequency sample,
+//  in double precision. Only the non-negative frequencies are stored,
+//  the transforms of real inputs are Hermitian symmetric.
 //
-template< class TransformData >
-static std::complex<double>
-circEvenPartAt( const TransformData & td, long idx )
+template < typename T >
+inline std::complex< double > 
+BasicReassignedSpectrum< T >::spectrumAt( const std::vector< std::complex< T > > & halfSpectrum, long idx ) const
 {
-    const long N = td.size();
+    const long N = size();
     while( idx < 0 )
     {
         idx += N;
@@ -227,59 +307,16 @@ circEvenPartAt( const TransformData & td, long idx )
     {
         idx -= N;
     }
-
- 	long flip_idx;
-	if ( idx != 0 )
-	{
-		flip_idx = N - idx;
-	}
-	else
-    {
-		flip_idx = idx;
-	}
-		
-	return 0.5*( td[idx] + std::conj( td[flip_idx] ) );
-}   
-
-// ---------------------------------------------------------------------------
-//	circOddPartAt - helper
-// ---------------------------------------------------------------------------
-// Extract the circular odd part divided by j from Fourier transform data.
-// Used for computing two real transforms using a single complex transform.
-//
-template< class TransformData >
-static std::complex<double>
-circOddPartAt( const TransformData & td, long idx )
-{
-    const long N = td.size();
-    while( idx < 0 )
+    
+    if ( idx < long( halfSpectrum.size() ) )
     {
-        idx += N;
+        return std::complex< double >( halfSpectrum[ idx ] );
     }
-    while( idx >= N )
+    else
     {
-        idx -= N;
+        return std::conj( std::complex< double >( halfSpectrum[ N - idx ] ) );
     }
-
- 	long flip_idx;
-	if ( idx != 0 )
-	{
-		flip_idx = N - idx;
-	}
-	else
-    {
-		flip_idx = idx;
-	}
-
-	/*
-	const std::complex<double> minus_j(0,-1);
-	std::complex<double> tra_part = minus_j * 0.5 * 
-									( td[idx] - std::conj( td[flip_idx] ) );
-	*/
-	//	can compute this without complex multiplies:
-	std::complex<double> tmp = td[idx] - std::conj( td[flip_idx] );
-	return std::complex<double>( 0.5*tmp.imag(), -0.5*tmp.real() );
-}   
+}
 
 // ---------------------------------------------------------------------------
 //	frequencyCorrection
@@ -297,11 +334,12 @@ circOddPartAt( const TransformData & td, long idx )
 //	but it appears to give slightly worse results, for example, with 
 //	a square wave.
 //
+template < typename T >
 double
-ReassignedSpectrum::frequencyCorrection( long idx ) const
+BasicReassignedSpectrum< T >::frequencyCorrection( long idx ) const
 {
-	std::complex<double> X_h = circEvenPartAt( mMagnitudeTransform, idx );
-    std::complex<double> X_Dh = circEvenPartAt( mCorrectionTransform, idx );
+	std::complex<double> X_h = spectrumAt( mX_h, idx );
+    std::complex<double> X_Dh = spectrumAt( mX_Dh, idx );
 	
 	double num = X_h.real() * X_Dh.imag() -
 				 X_h.imag() * X_Dh.real();
@@ -323,11 +361,12 @@ ReassignedSpectrum::frequencyCorrection( long idx ) const
 //!	Correction is computed in fractional samples, because
 //!	that's the kind of ramp we used on our window.
 //
+template < typename T >
 double
-ReassignedSpectrum::timeCorrection( long idx ) const
+BasicReassignedSpectrum< T >::timeCorrection( long idx ) const
 {
-	std::complex<double> X_h = circEvenPartAt( mMagnitudeTransform, idx );
-	std::complex<double> X_Th = circOddPartAt( mCorrectionTransform, idx ); 
+	std::complex<double> X_h = spectrumAt( mX_h, idx );
+	std::complex<double> X_Th = spectrumAt( mX_Th, idx ); 
 
 	double num = X_h.real() * X_Th.real() +
 		  		 X_h.imag() * X_Th.imag();
@@ -349,8 +388,9 @@ ReassignedSpectrum::timeCorrection( long idx ) const
 //! \param  idx the frequency sample at which to evaluate the
 //!         transform
 //
+template < typename T >
 double
-ReassignedSpectrum::reassignedFrequency( long idx ) const
+BasicReassignedSpectrum< T >::reassignedFrequency( long idx ) const
 {
 #if ! defined(USE_PARABOLIC_INTERPOLATION)
 
@@ -358,9 +398,9 @@ ReassignedSpectrum::reassignedFrequency( long idx ) const
 	
 #else // defined(USE_PARABOLIC_INTERPOLATION)
 
-	double dbLeft = 20. * log10( abs( circEvenPartAt( mMagnitudeTransform, idx-1 ) ) );
-	double dbCandidate = 20. * log10( abs( circEvenPartAt( mMagnitudeTransform, idx ) ) );
-	double dbRight = 20. * log10( abs( circEvenPartAt( mMagnitudeTransform, idx+1 ) ) );
+	double dbLeft = 20. * log10( abs( spectrumAt( mX_h, idx-1 ) ) );
+	double dbCandidate = 20. * log10( abs( spectrumAt( mX_h, idx ) ) );
+	double dbRight = 20. * log10( abs( spectrumAt( mX_h, idx+1 ) ) );
 	
 	double peakXOffset = 0.5 * (dbLeft - dbRight) /
 						 (dbLeft - 2.0 * dbCandidate + dbRight);
@@ -379,8 +419,9 @@ ReassignedSpectrum::reassignedFrequency( long idx ) const
 //! \param  idx the frequency sample at which to evaluate the
 //!         transform
 //
+template < typename T >
 double
-ReassignedSpectrum::reassignedTime( long idx ) const
+BasicReassignedSpectrum< T >::reassignedTime( long idx ) const
 {
 	return timeCorrection( idx );
 }
@@ -394,23 +435,24 @@ ReassignedSpectrum::reassignedTime( long idx ) const
 //! \param  idx the frequency sample at which to evaluate the
 //!         transform
 //
+template < typename T >
 double
-ReassignedSpectrum::reassignedMagnitude( long idx ) const
+BasicReassignedSpectrum< T >::reassignedMagnitude( long idx ) const
 {
 #if ! defined(USE_PARABOLIC_INTERPOLATION)
 	
 	//	compute the nominal spectral amplitude by scaling
 	//	the peak spectral sample:
-	return abs( circEvenPartAt( mMagnitudeTransform, idx ) );
+	return abs( spectrumAt( mX_h, idx ) );
 	
 #else // defined(USE_PARABOLIC_INTERPOLATION)
 	
 	//	keep this parabolic interpolation computation around
 	//	only for sake of comparison, it is unlikely to yield
 	//	good results with bandwidth association:
-	double dbLeft = 20. * log10( abs( circEvenPartAt( mMagnitudeTransform, idx-1 ) ) );
-	double dbCandidate = 20. * log10( abs( circEvenPartAt( mMagnitudeTransform, idx ) ) );
-	double dbRight = 20. * log10( abs( circEvenPartAt( mMagnitudeTransform, idx+1 ) ) );
+	double dbLeft = 20. * log10( abs( spectrumAt( mX_h, idx-1 ) ) );
+	double dbCandidate = 20. * log10( abs( spectrumAt( mX_h, idx ) ) );
+	double dbRight = 20. * log10( abs( spectrumAt( mX_h, idx+1 ) ) );
 	
 	double peakXOffset = 0.5 * (dbLeft - dbRight) /
 						 (dbLeft - 2.0 * dbCandidate + dbRight);
@@ -432,10 +474,11 @@ ReassignedSpectrum::reassignedMagnitude( long idx ) const
 //! \param  idx the frequency sample at which to evaluate the
 //!         transform
 //
+template < typename T >
 double
-ReassignedSpectrum::reassignedPhase( long idx ) const
+BasicReassignedSpectrum< T >::reassignedPhase( long idx ) const
 {
-	double phase = arg( circEvenPartAt( mMagnitudeTransform, idx ) );
+	double phase = arg( spectrumAt( mX_h, idx ) );
 	
 	const double offsetTime = timeCorrection( idx );
 	const double offsetFreq = frequencyCorrection( idx );
@@ -458,13 +501,13 @@ ReassignedSpectrum::reassignedPhase( long idx ) const
     //  offsetFreq is in fractional frequency samples
     if ( offsetFreq > 0 )
     {
-        double nextphase = arg( circEvenPartAt( mMagnitudeTransform, idx+1 ) );
+        double nextphase = arg( spectrumAt( mX_h, idx+1 ) );
         double slope = nextphase - phase;
         phase += offsetFreq * slope;
     }
     else
     {   
-        double prevphase = arg( circEvenPartAt( mMagnitudeTransform, idx-1 ) );
+        double prevphase = arg( spectrumAt( mX_h, idx-1 ) );
         double slope = phase - prevphase;
         phase += offsetFreq * slope;
     }
@@ -495,15 +538,16 @@ ReassignedSpectrum::reassignedPhase( long idx ) const
 //! \param  idx the frequency sample at which to evaluate the
 //!         transform
 //
+template < typename T >
 double
-ReassignedSpectrum::convergence( long idx ) const
+BasicReassignedSpectrum< T >::convergence( long idx ) const
 {
 #if defined(COMPUTE_MIXED_PHASE_DERIVATIVE)
 
-  	std::complex<double> X_h = circEvenPartAt( mMagnitudeTransform, idx );
-	std::complex<double> X_Th = circOddPartAt( mCorrectionTransform, idx ); 
-    std::complex<double> X_Dh = circEvenPartAt( mCorrectionTransform, idx );
-    std::complex<double> X_TDh = circOddPartAt( mMagnitudeTransform, idx );
+  	std::complex<double> X_h = spectrumAt( mX_h, idx );
+	std::complex<double> X_Th = spectrumAt( mX_Th, idx ); 
+    std::complex<double> X_Dh = spectrumAt( mX_Dh, idx );
+    std::complex<double> X_TDh = spectrumAt( mX_TDh, idx );
 
 	double term1 = (X_TDh * conj(X_h)).real() / norm( X_h );
 	double term2 = ((X_Th * X_Dh) / (X_h * X_h)).real();
@@ -528,10 +572,11 @@ ReassignedSpectrum::convergence( long idx ) const
 //  but since the reference returned was const, this version should 
 //  keep most old code working, if not all.
 //
+template < typename T >
 std::complex< double >
-ReassignedSpectrum::operator[]( unsigned long idx ) const
+BasicReassignedSpectrum< T >::operator[]( unsigned long idx ) const
 {
-    return circEvenPartAt( mMagnitudeTransform, idx );
+    return spectrumAt( mX_h, idx );
 }
 
 // ---------------------------------------------------------------------------
@@ -578,7 +623,7 @@ static inline void applyFreqRamp( vector< double > & w  )
 	//	and has to be scaled by the ratio of the 
 	//	transform lengths, so that k spans the length
 	//	of the padded transforms, N)
-	for ( int k = 0 ; k < temp.size(); ++k ) 
+	for ( std::size_t k = 0 ; k < temp.size(); ++k ) 
 	{
 	   double x = (double)k;   // to get type promotion right
 		if ( k < temp.size() / 2 ) 
@@ -601,7 +646,7 @@ static inline void applyFreqRamp( vector< double > & w  )
 	//	seems that I want the imaginary part of the index-reversed
 	//	transform scaled by the size of the transform:
 	std::reverse( temp.begin() + 1, temp.end() );
-	for ( int i = 0; i < w.size(); ++i ) 
+	for ( std::size_t i = 0; i < w.size(); ++i ) 
 	{
 		w[i] = - imag( temp[i] ) / temp.size();
 	}
@@ -619,7 +664,7 @@ static inline void applyTimeRamp( vector< double > & w )
 	//	need a fractional value for even-length windows, a
 	//	whole number for odd-length windows:
 	double offset = 0.5 * ( w.size() - 1 );
-	for ( int k = 0 ; k < w.size(); ++k ) 
+	for ( std::size_t k = 0 ; k < w.size(); ++k ) 
 	{
 		w[ k ] *= ( k - offset );
 	}
@@ -636,8 +681,9 @@ static inline void applyTimeRamp( vector< double > & w )
 //
 //  Input is the unmodified window function.
 //
+template < typename T >
 void 
-ReassignedSpectrum::buildReassignmentWindows( const std::vector< double > & window )
+BasicReassignedSpectrum< T >::buildReassignmentWindows( const std::vector< double > & window )
 {
     mWindow.resize( window.size(), 0. );
 	
@@ -673,10 +719,10 @@ ReassignedSpectrum::buildReassignmentWindows( const std::vector< double > & wind
     mCplxWin_Wd_Wt.resize( mWindow.size(), 0. );
 
 	std::transform( framp.begin(), framp.end(), tramp.begin(),
-					mCplxWin_Wd_Wt.begin(), make_complex< double >() );	
+					mCplxWin_Wd_Wt.begin(), make_complex< T >() );	
     
 	std::transform( mWindow.begin(), mWindow.end(), tframp.begin(),
-					mCplxWin_W_Wtd.begin(), make_complex< double >() );	
+					mCplxWin_W_Wtd.begin(), make_complex< T >() );	
 }
 
 // ---------------------------------------------------------------------------
@@ -692,9 +738,10 @@ ReassignedSpectrum::buildReassignmentWindows( const std::vector< double > & wind
 //  DFT kludge is unnecessary.
 //
 
+template < typename T >
 void 
-ReassignedSpectrum::buildReassignmentWindows( const std::vector< double > & window,
-                                              const std::vector< double > & windowDerivative )  
+BasicReassignedSpectrum< T >::buildReassignmentWindows( const std::vector< double > & window,
+                                                        const std::vector< double > & windowDerivative )  
 {
 
     mWindow.resize( window.size(), 0. );
@@ -737,11 +784,15 @@ ReassignedSpectrum::buildReassignmentWindows( const std::vector< double > & wind
     mCplxWin_Wd_Wt.resize( mWindow.size(), 0. );
 
 	std::transform( framp.begin(), framp.end(), tramp.begin(),
-					mCplxWin_Wd_Wt.begin(), make_complex< double >() );	
+					mCplxWin_Wd_Wt.begin(), make_complex< T >() );	
     
 	std::transform( mWindow.begin(), mWindow.end(), tframp.begin(),
-					mCplxWin_W_Wtd.begin(), make_complex< double >() );	
+					mCplxWin_W_Wtd.begin(), make_complex< T >() );	
 }
 
 
+//  the supported precisions
+template class BasicReassignedSpectrum< double >;
+template class BasicReassignedSpectrum< float >;
+
 }	//	end of namespace Loris
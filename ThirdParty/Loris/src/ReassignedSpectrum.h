@@ -24,7 +24,9 @@
  *
  * ReassignedSpectrum.h
  *
- * Definition of class Loris::ReassignedSpectrum.
+ * Definition of class template Loris::BasicReassignedSpectrum, and
+ * its double and single precision instances Loris::ReassignedSpectrum
+ * and Loris::ReassignedSpectrumFloat.
  *
  * Kelly Fitz, 7 Dec 1999
  * loris@cerlsoundgroup.org
@@ -40,32 +42,38 @@
 namespace Loris {
 
 // ---------------------------------------------------------------------------
-//	class ReassignedSpectrum
+//	class BasicReassignedSpectrum
 //
 //!	Computes a reassigned short-time Fourier spectrum using the transform
 //! method of Auger and Flandrin. 
+//!
+//! Samples, windows and transforms have the precision of T. The windows
+//! are built in double precision and rounded once. The reassigned
+//! frequencies, times, magnitudes and phases are always computed in
+//! double precision from the transform data.
 //	
-class ReassignedSpectrum
+template < typename T >
+class BasicReassignedSpectrum
 {
 //	-- public interface --
 public:
     //! An unsigned integral type large enough
     //! to represent the length of any transform.
-    typedef FourierTransform::size_type size_type;
+    typedef typename BasicFourierTransform< T >::size_type size_type;
 
 //	--- lifecycle ---
 
     //! Construct a new instance using the specified short-time window.
     //!	Transform lengths are the smallest power of two greater than twice the
     //!	window length.
-	ReassignedSpectrum( const std::vector< double > & window );
+	BasicReassignedSpectrum( const std::vector< double > & window );
 
     //! Construct a new instance using the specified short-time window and
     //! its time derivative.
     //!	Transform lengths are the smallest power of two greater than twice the
     //!	window length.
-	ReassignedSpectrum( const std::vector< double > & window,
-                        const std::vector< double > & windowDerivative );
+	BasicReassignedSpectrum( const std::vector< double > & window,
+                             const std::vector< double > & windowDerivative );
     
 	// compiler-generated copy, assign, and destroy are sufficient
 
@@ -87,7 +95,7 @@ public:
     //! \post   the transform buffers store the reassigned 
     //!         short-time transform data for the specified 
     //!         samples
-	void transform( const double * sampsBegin, const double * pos, const double * sampsEnd );
+	void transform( const T * sampsBegin, const T * pos, const T * sampsEnd );
 	
 //	--- inquiry ---
 
@@ -203,26 +211,49 @@ private:
     void buildReassignmentWindows( const std::vector< double > & window,
                                    const std::vector< double > & windowDerivative );    
 
+//	-- spectrum access helper --
+
+    //  Return a sample of a separated transform at any frequency sample,
+    //  in double precision. Only the non-negative frequencies are stored,
+    //  the transforms of real inputs are Hermitian symmetric.
+    std::complex< double > 
+    spectrumAt( const std::vector< std::complex< T > > & halfSpectrum, long idx ) const;
+
 //	-- instance variables --
 
 	//! the FourierTransform for computing magnitude and phase
-	FourierTransform mMagnitudeTransform;
+	BasicFourierTransform< T > mMagnitudeTransform;
 	
 	//! the FourierTransform for computing time and frequency corrections
-	FourierTransform mCorrectionTransform;
+	BasicFourierTransform< T > mCorrectionTransform;
 	
 	//! the original short-time analysis window samples
 	std::vector< double > mWindow;                          //  W(n)
 	
 	//! the complex window used to compute the 
     //! magnitude/phase transform
-	std::vector< std::complex< double > > mCplxWin_W_Wtd;   //  real W(n), imag nW'(n)
+	std::vector< std::complex< T > > mCplxWin_W_Wtd;        //  real W(n), imag nW'(n)
 
 	//! the complex window used to compute the 
     //! time/frequency correction transform
-	std::vector< std::complex< double > > mCplxWin_Wd_Wt;   //  real W'(n), imag nW(n)
+	std::vector< std::complex< T > > mCplxWin_Wd_Wt;        //  real W'(n), imag nW(n)
+
+	//! the transforms of the four real-windowed inputs, separated
+	//! from the two complex transforms once per frame, having only
+	//! the non-negative frequencies
+	std::vector< std::complex< T > > mX_h;                  //  W(n)
+	std::vector< std::complex< T > > mX_Dh;                 //  W'(n)
+	std::vector< std::complex< T > > mX_Th;                 //  nW(n)
+	std::vector< std::complex< T > > mX_TDh;                //  nW'(n)
 		
-};	//	end of class ReassignedSpectrum
+};	//	end of class BasicReassignedSpectrum
+
+//! Double precision reassigned spectrum, used for reference quality analysis.
+typedef BasicReassignedSpectrum< double > ReassignedSpectrum;
+
+//! Single precision reassigned spectrum, half the memory traffic and
+//! twice the SIMD width of the double precision one.
+typedef BasicReassignedSpectrum< float > ReassignedSpectrumFloat;
 
 }	//	end of namespace Loris
 
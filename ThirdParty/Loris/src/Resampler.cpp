@@ -55,7 +55,7 @@
 namespace Loris {
 
 //  helper declarations:
-static Partial::iterator insert_resampled_at( Partial & newp, const Partial & p, 
+static Partial::iterator insert_resampled_at( Partial & newp, Partial::Cursor & pAt, 
                                               double sampleTime, double insertTime );
 
 /*
@@ -151,12 +151,13 @@ Resampler::resample( Partial & p ) const
 	double lastInsertTime  = p.endTime() + ( 0.5 * interval_ );
 		
 	//  resample:
+	Partial::Cursor pAt( p );
 	for (  double tins = firstInsertTime; tins <= lastInsertTime; tins += interval_ ) 
 	{
 	    //  sample time is obtained from the timing envelope, if specified, 
 	    //  otherwise same as the insert time:
 	    double tsamp = tins;
-        insert_resampled_at( newp, p, tins, tins );        
+        insert_resampled_at( newp, pAt, tins, tins );        
 	}
 	
 	//	store the new Partial:
@@ -214,17 +215,20 @@ Resampler::resample( Partial & p, const LinearEnvelope & timingEnv ) const
 	double firstInsertTime = interval_ * int( 0.5 + timingEnv.begin()->first / interval_ );
     double lastInsertTime = (--timingEnv.end())->first + ( 0.5 * interval_ );
 	
-	//  resample:
+	//  resample, the timing envelope is evaluated at increasing 
+	//  times, and so is the Partial if the envelope is monotonic:
+	LinearEnvelope::Cursor timingAt( timingEnv );
+	Partial::Cursor pAt( p );
 	for (  double insertTime = firstInsertTime; 
 	       insertTime <= lastInsertTime; 
 	       insertTime += interval_ ) 
 	{
 	    //  sample time is obtained from the timing envelope, if specified, 
 	    //  otherwise same as the insert time:
-	    double sampleTime = timingEnv.valueAt( insertTime );	    	            
+	    double sampleTime = timingAt.valueAt( insertTime );	    	            
         
         //  make a resampled Breakpoint:
-        Breakpoint newbp = p.parametersAt( sampleTime );
+        Breakpoint newbp = pAt.parametersAt( sampleTime );
                 
         Partial::iterator ret_pos = newp.insert( insertTime, newbp );
                 
@@ -297,6 +301,7 @@ void Resampler::quantize( Partial & p ) const
 	Partial newp;
 	newp.setLabel( p.label() );
 	
+	Partial::Cursor pAt( p );
 	Partial::const_iterator iter = p.begin();        
 	while( iter != p.end() )
 	{            
@@ -325,7 +330,7 @@ void Resampler::quantize( Partial & p ) const
             //  sample the Partial with a long fade time so that 
             //  the amplitudes at the ends keep their original values:
             const double a_long_time = 1.;
-            Breakpoint newbp = p.parametersAt( qt, a_long_time );
+            Breakpoint newbp = pAt.parametersAt( qt, a_long_time );
             Partial::iterator new_pos = newp.insert( qt, newbp );
             
             //  tricky: if the quantized position (iter) is a null Breakpoint, 
@@ -370,11 +375,13 @@ void Resampler::quantize( Partial & p ) const
 // ---------------------------------------------------------------------------
 //
 static Partial::iterator 
-insert_resampled_at( Partial & newp, const Partial & p, 
+insert_resampled_at( Partial & newp, Partial::Cursor & pAt, 
                      double sampleTime, double insertTime )
 {
+    const Partial & p = pAt.partial();
+    
     //  make a resampled Breakpoint:
-    Breakpoint newbp = p.parametersAt( sampleTime );
+    Breakpoint newbp = pAt.parametersAt( sampleTime );
     
     //  handle end points to reduce error at ends
     if ( sampleTime < p.startTime() )
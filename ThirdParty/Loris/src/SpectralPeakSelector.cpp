@@ -79,8 +79,9 @@ SpectralPeakSelector::SpectralPeakSelector( double srate, double maxTimeCorrecti
 //  There are two strategies for doing. Probably each one should be a 
 //  separate class, but for now, they are just separate functions.
 
+template < typename T >
 Peaks
-SpectralPeakSelector::selectPeaks( ReassignedSpectrum & spectrum, 
+SpectralPeakSelector::selectPeaks( BasicReassignedSpectrum< T > & spectrum, 
                                    double minFrequency )
 {
 #if defined(USE_REASSIGNMENT_MINS) && USE_REASSIGNMENT_MINS
@@ -97,8 +98,9 @@ SpectralPeakSelector::selectPeaks( ReassignedSpectrum & spectrum,
 // ---------------------------------------------------------------------------
 //	selectReassignmentMinima (private)
 // ---------------------------------------------------------------------------
+template < typename T >
 Peaks
-SpectralPeakSelector::selectReassignmentMinima( ReassignedSpectrum & spectrum, 
+SpectralPeakSelector::selectReassignmentMinima( BasicReassignedSpectrum< T > & spectrum, 
                                                 double minFrequency )
 {
 	using namespace std; // for abs and fabs
@@ -184,8 +186,9 @@ SpectralPeakSelector::selectReassignmentMinima( ReassignedSpectrum & spectrum,
 // ---------------------------------------------------------------------------
 //	selectMagnitudePeaks (private)
 // ---------------------------------------------------------------------------
+template < typename T >
 Peaks
-SpectralPeakSelector::selectMagnitudePeaks( ReassignedSpectrum & spectrum,
+SpectralPeakSelector::selectMagnitudePeaks( BasicReassignedSpectrum< T > & spectrum,
                                             double minFrequency )
 {
 	using namespace std; // for abs and fabs
@@ -245,5 +248,8 @@ SpectralPeakSelector::selectMagnitudePeaks( ReassignedSpectrum & spectrum,
 	return peaks;
 }
 
+//  the supported precisions
+template Peaks SpectralPeakSelector::selectPeaks( BasicReassignedSpectrum< double > &, double );
+template Peaks SpectralPeakSelector::selectPeaks( BasicReassignedSpectrum< float > &, double );
 
 }	//	end of namespace Loris
@@ -39,7 +39,7 @@
 //	begin namespace
 namespace Loris {
 
-class ReassignedSpectrum;
+template < typename T > class BasicReassignedSpectrum;
 
 // ---------------------------------------------------------------------------
 //	class SpectralPeakSelector
@@ -62,7 +62,10 @@ public:
 	//
     //  There are two strategies for doing. Probably each one should be a 
     //  separate class, but for now, they are just separate functions.
-    Peaks selectPeaks( ReassignedSpectrum & spectrum, double minFrequency = 0 );
+    //
+    //  Defined for spectra of double and float samples.
+    template < typename T >
+    Peaks selectPeaks( BasicReassignedSpectrum< T > & spectrum, double minFrequency = 0 );
     
     	
 // --- implementation ---
@@ -73,8 +76,10 @@ private:
     //
     //  Currently, the reassignment minima are used.
     
-    Peaks selectReassignmentMinima( ReassignedSpectrum & spectrum, double minFrequency );
-    Peaks selectMagnitudePeaks( ReassignedSpectrum & spectrum, double minFrequency );
+    template < typename T >
+    Peaks selectReassignmentMinima( BasicReassignedSpectrum< T > & spectrum, double minFrequency );
+    template < typename T >
+    Peaks selectMagnitudePeaks( BasicReassignedSpectrum< T > & spectrum, double minFrequency );
         
 
 // --- member data ---
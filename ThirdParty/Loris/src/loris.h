@@ -66,12 +66,13 @@
 /* The (class) types Breakpoint, LinearEnvelope, Partial, 
    and PartialList are imported from the Loris namespace.
    The first three are classes, the latter is a typedef
-   for std::list< Loris::Partial >. 
+   for std::list< Loris::Partial > with pooled nodes. 
  */
 #if defined(__cplusplus)
     //    include std library list header, declaring templates
     //    is too painful and fragile:
     #include <list>
+    #include "NodePool.h"
     
     //    declare Loris classes in Loris namespace:
     namespace Loris
@@ -81,7 +82,7 @@
         class Partial;
       
         //    this typedef has to be copied from PartialList.h
-        typedef std::list< Loris::Partial > PartialList;
+        typedef std::list< Loris::Partial, Loris::NodePoolAllocator< Loris::Partial > > PartialList;
     }
    
    // import those names into the global namespace